@@ -12,8 +12,11 @@ Purpose:
         Vertex
         Graph
         GraphImp
+        PertContext
+        PertContextImp
  Protypes 
         PERT functions to be coded by students
+        PERT library functions (including queries)
         Aid printing the graph
         Building the graph
         Utility functions provided by Larry
@@ -28,7 +31,12 @@ Notes:
 #define MAX_VERTICES 100
 #define MAX_EDGES 100
 
-// Error constants (program exit values)
+// Graphs with at most this many vertices are computed using bit masks
+// (one bit per vertex in a 64-bit mask).  See computePertSmall.
+#define SMALL_GRAPH_VERTICES 64
+
+// Error constants (program exit values and library return codes)
+#define PERT_OK             0      // library function succeeded
 #define ERR_COMMAND_LINE    900    // invalid command line argument
 #define ERR_ALGORITHM       903    // Error in algorithm - almost anything else
 #define ERR_BAD_INPUT       503    // Bad input 
@@ -42,16 +50,78 @@ Notes:
 #define USAGE_ONLY          0      // user only requested usage information
 #define USAGE_ERR           -1     // usage error, show message and usage information
 
+// Output formats selected by the -f switch
+#define FORMAT_TEXT         0      // tables for people (the default)
+#define FORMAT_CSV          1
+#define FORMAT_JSONL        2      // JSON Lines
+#define FORMAT_BINARY       3
+
+// Options from the command switches (see processCommandSwitches)
+typedef struct
+{
+    int iFormat;                    // FORMAT_TEXT, FORMAT_CSV, ...
+    int bRemoveRedundant;           // TRUE to remove redundant edges
+    char *pszSocketPath;            // server socket (NULL if not a server)
+    char *pszCachePath;             // result cache file (NULL if none)
+    int iCacheEntries;              // size of a new result cache file
+    int bCrash;                     // TRUE to print the crashing curve
+    char *pszScenarioPath;          // what-if scenario file (NULL if none)
+    char *pszOutOfCorePath;         // out-of-core result file (NULL if none)
+    int iMemoryMB;                  // out-of-core memory budget
+} Options;
+
 // boolean constants
 #define FALSE 0
 #define TRUE 1
 
+#include <stdint.h>
+
+// Weight is the type of path weights and PERT distances.  It is an int
+// unless the program is compiled with one of:
+//     -DWEIGHT_INT64     64-bit durations (long schedules in seconds)
+//     -DWEIGHT_DOUBLE    fractional durations
+// WEIGHT_SCN and WEIGHT_PRT are the scanf and printf conversions (after
+// the '%'), WEIGHT_OUT prints the exact value for the machine-readable
+// output formats, WEIGHT_KIND identifies the type in files and 
+// WEIGHT_EQUAL is the test used to decide if TE equals TL.
+// Doubles are compared with a relative tolerance since TE and TL are 
+// computed by summing along different paths.
+#if defined(WEIGHT_DOUBLE)
+#include <float.h>
+typedef double Weight;
+#define WEIGHT_SCN          "lf"
+#define WEIGHT_PRT          "2g"
+#define WEIGHT_OUT          ".17g"
+#define WEIGHT_MIN          (-DBL_MAX)
+#define WEIGHT_KIND         'd'
+#define WEIGHT_EPSILON      1e-9
+#define WEIGHT_EQUAL(w1, w2) weightEqual(w1, w2)
+#elif defined(WEIGHT_INT64)
+#include <inttypes.h>
+typedef int64_t Weight;
+#define WEIGHT_SCN          SCNd64
+#define WEIGHT_PRT          "2" PRId64
+#define WEIGHT_OUT          PRId64
+#define WEIGHT_MIN          INT64_MIN
+#define WEIGHT_KIND         'l'
+#define WEIGHT_EQUAL(w1, w2) ((w1) == (w2))
+#else
+#include <limits.h>
+typedef int Weight;
+#define WEIGHT_SCN          "d"
+#define WEIGHT_PRT          "2d"
+#define WEIGHT_OUT          "d"
+#define WEIGHT_MIN          INT_MIN
+#define WEIGHT_KIND         'i'
+#define WEIGHT_EQUAL(w1, w2) ((w1) == (w2))
+#endif
+
 // Represent the Graph using a double adjacency list
 typedef struct Edge
 {
     int iVertex;                    // If successor, this is TO vertex.  
                                     // If predecessor, this is FROM vertex.
-    int iPath;                      // This is the weight of this arc.
+    Weight iPath;                   // This is the weight of this arc.
 } Edge;
 // An edge node contains an edge and a next pointer
 typedef struct EdgeNode
@@ -64,18 +134,25 @@ typedef struct EdgeNode
 typedef struct Vertex
 {
     char cLabel;
-    int iMaxFromSource;
-    int iMaxFromSink;
-    int iTL;
+    Weight iMaxFromSource;
+    Weight iMaxFromSink;
+    Weight iTL;
     EdgeNode * successorList;
     EdgeNode * predecessorList;
 } Vertex;
 // The Graph Implementation is an array of vertices with each vertex
 // containing a pointer to a successor list and a predecessor list.
+// The EdgeNodes for both lists are carved out of edgeNodeM so building
+// a graph does not malloc each edge.  buildGraph lays the successor
+// nodes out grouped by FROM vertex (CSR order) followed by the 
+// predecessor nodes grouped by TO vertex.
 typedef struct
 {
     int iNumVertices;
     Vertex vertexM[MAX_VERTICES];
+    int iNumEdges;                  // number of distinct edges in the lists
+    uint64_t ullEdgeHash;           // sum of hashEdge of the edges in the lists
+    EdgeNode edgeNodeM[2 * MAX_EDGES];
 } GraphImp;
 typedef GraphImp *Graph;
 
@@ -85,39 +162,461 @@ struct Data
 {
     char cFrom;
     char cTo;
-    int iPath;
+    Weight iPath;
 };
 
+// Number of what-if scenarios evaluated together by pertEvaluateScenarios
+#define SCENARIO_BLOCK 32
+
+// Most scenarios and overrides in one set of a scenario file (see 
+// getScenarioData)
+#define MAX_SCENARIOS 10000
+#define MAX_OVERRIDES 10000
+
+// A reduced graph is a graph with its chains of single predecessor, single
+// successor vertices contracted into edges (see reduceGraph).  For each
+// vertex of the original graph, iHeadM is itself if the vertex was kept.
+// Otherwise it is the kept vertex at the start of the vertex's chain and
+// iTailM is the one at the end.
+typedef struct
+{
+    GraphImp graph;                     // vertices are labeled 1, 2, ...
+    int iKeptM[MAX_VERTICES];           // original vertex for label - 1
+    int iHeadM[MAX_VERTICES];           // start of each vertex's chain
+    int iTailM[MAX_VERTICES];           // end of each vertex's chain
+    Weight offsetM[MAX_VERTICES];       // distance from the chain's start
+    Weight restM[MAX_VERTICES];         // distance to the chain's end
+} ReducedGraph;
+
+// A PERT context owns a graph so a program can build, compute and query
+// graphs without the global dataM or exiting on an error.  Contexts are
+// independent of each other and may be reused for any number of graphs.
+// The scenario arrays have one row per vertex (or edge) holding that
+// vertex's value for each of the SCENARIO_BLOCK scenarios.
+typedef struct
+{
+    GraphImp graph;                 // graph built by pertBuild
+    int bComputed;                  // TRUE if TE and TL are current
+    int iLabelM[256];               // vertex subscript for each label (-1 if none)
+    char szErrMsg[100];             // describes the last error
+    // scratch for pertEvaluateScenarios
+    Weight scenarioTeM[MAX_VERTICES * SCENARIO_BLOCK];
+    Weight scenarioSinkM[MAX_VERTICES * SCENARIO_BLOCK];
+    Weight scenarioPathM[MAX_EDGES * SCENARIO_BLOCK];
+} PertContextImp;
+typedef PertContextImp *PertContext;
+
+// A what-if duration for one edge in one scenario
+typedef struct
+{
+    int iScenario;                  // 0 .. number of scenarios - 1
+    char cFrom;
+    char cTo;
+    Weight iPath;                   // the edge's weight in that scenario
+} Override;
+
+// Number of 64-bit words in a mask with one bit per vertex.  Vertex v
+// (a subscript of vertexM) is bit v % 64 of word v / 64.
+#define VERTEX_MASK_WORDS ((MAX_VERTICES + 63) / 64)
+
+// The result of one what-if scenario, compared with the context's graph
+typedef struct
+{
+    Weight maxTE;                   // the scenario's largest TE (makespan)
+    int iNumNowCritical;            // vertices that became critical
+    int iNumNoLongerCritical;       // critical vertices that aren't any more
+    uint64_t nowCriticalM[VERTEX_MASK_WORDS];       // which ones became
+    uint64_t noLongerCriticalM[VERTEX_MASK_WORDS];  // and which stopped
+} ScenarioResult;
+
+// The crash weight and cost slope of an edge that can be shortened
+typedef struct
+{
+    char cFrom;
+    char cTo;
+    Weight crash;                   // shortest the path weight can be
+    Weight slope;                   // cost of shortening it by 1
+} Crash;
+
+// Function called with each point of a crashing curve.  crashedM has the
+// iNumCrashed edges changed by the step with their new path weights.
+typedef void (*CrashStepFn)(Weight makespan, Weight cost, struct Data crashedM[]
+    , int iNumCrashed, void *pState);
+
+// Flow network of the critical edges used by pertCrash.  Nodes 0 .. 
+// iNumVertices - 1 are the vertices, then the source, the sink and the 
+// source and sink used to meet the lower bounds (see crashCut).
+typedef struct
+{
+    Weight capM[MAX_VERTICES + 4][MAX_VERTICES + 4];  // residual capacities
+    Weight normalM[MAX_VERTICES][MAX_VERTICES];       // input weight of each edge
+    Weight crashM[MAX_VERTICES][MAX_VERTICES];        // crash weight of each edge
+    Weight slopeM[MAX_VERTICES][MAX_VERTICES];        // cost slope of each edge
+} CrashNetwork;
+
+// The PERT results for one vertex as returned by the query functions
+typedef struct
+{
+    char cLabel;
+    Weight iTE;
+    Weight iTL;
+    Weight iSlack;                  // TL - TE
+    int bCritical;                  // TRUE if TE equals TL
+} VertexResult;
+
+// Function called with each critical path.  szPath has the labels of the
+// iLength vertices on the path.
+typedef void (*CriticalPathFn)(char szPath[], int iLength, void *pState);
+
+#define PATH_LIST_SIZE  2048    // bytes of critical paths per graph
+
+// A graph's critical paths, each as a length byte followed by its labels
+typedef struct
+{
+    int iLength;                    // bytes used (-1 if the paths didn't fit)
+    char szListM[PATH_LIST_SIZE];
+} PathList;
+
 // prototypes for PERT functions that you must code
-void computePertTEAndTL(Graph graph);
-void freeLL(EdgeNode *edge);
+int computePertTEAndTL(Graph graph);
+int computePertSmall(Graph graph);
+int computePertLevels(Graph graph);
+int topologicalOrder(Graph graph, int iOrderM[]);
+int removeRedundantEdges(Graph graph, int *piNumRemoved);
+void unlinkEdge(EdgeNode **ppHead, int iVertex);
+int reduceGraph(Graph graph, ReducedGraph *pReduced);
+void expandReducedGraph(Graph graph, ReducedGraph *pReduced);
+int lowestBit(uint64_t mask);
 void freeGraph(Graph graph);
-void depthFirstPrintCriticalPaths(Graph g, int v, char szCriticalPath[], int iIndex);
-void updateTL(Graph g, int maximumTE);
-int findMaxTE(Graph g);
-void computeMaxDistFromSource(Graph g, int v, int iPathLength);
-void computeMaxDistFromSink(Graph g, int v, int iPathLength);
+void depthFirstCriticalPaths(Graph g, int v, char szCriticalPath[], int iIndex
+    , CriticalPathFn pfnPath, void *pState);
+int forEachCriticalPath(Graph g, CriticalPathFn pfnPath, void *pState);
+Weight findMaxTE(Graph g);
 void printCriticalPaths(Graph g);
-int findSinks(Graph g, int iSinkM[]);
 int findSources(Graph g, int iSourceM[]);
-void maxDistFromSource(Graph g);
-void maxDistFromSink(Graph g);
+
+// prototypes for using PERT as a library (return PERT_OK or an ERR_ constant)
+PertContext newPertContext();
+void freePertContext(PertContext ctx);
+int pertBuild(PertContext ctx, struct Data dataM[]);
+int pertCompute(PertContext ctx);
+Graph pertGraph(PertContext ctx);
+void pertReset(PertContext ctx);
+char *pertErrorMessage(PertContext ctx);
+int pertQueryVertex(PertContext ctx, char cLabel, VertexResult *pResult);
+int pertExportVertices(PertContext ctx, VertexResult resultM[], int *piNumVertices);
+int pertExportCriticalEdges(PertContext ctx, struct Data edgeM[], int *piNumEdges);
+int pertRemoveRedundantEdges(PertContext ctx, int *piNumRemoved);
+int pertUpdatePath(PertContext ctx, char cFrom, char cTo, Weight iPath);
+int pertEvaluateScenarios(PertContext ctx, Override overrideM[], int iNumOverrides
+    , int iNumScenarios, ScenarioResult resultM[]);
+int findScenarioEdge(PertContext ctx, int iSuccStartM[], int iSuccToM[], Override *pOverride);
+void evaluateScenarioBlock(PertContext ctx, int iOrderM[], int iSuccStartM[], int iSuccToM[]
+    , int iNumScenarios, ScenarioResult resultM[]);
+int pertCrash(PertContext ctx, Crash crashM[], Weight deadline
+    , CrashStepFn pfnStep, void *pState);
+void crashUpdateTimes(Graph g, int iOrderM[], int iFromM[], int iToM[], int iNumChanged);
+int crashCut(Graph g, CrashNetwork *pNet, int iFromM[], int iToM[], int iChangeM[]);
+Weight crashMaxFlow(CrashNetwork *pNet, int iNumNodes, int iSource, int iSink
+    , Weight limit, int iParentM[]);
+void getVertexResult(Graph g, int v, VertexResult *pResult);
+int isCriticalEdge(Graph g, int iFrom, Edge edge);
 
 // prototypes to aid printing
 void printGraph(int iRun, char *pszSubject, Graph graph);
 void printSpaces(char szSpaces[], int iRepeat);
 
+// prototypes for the output formats
+void writeResults(int iFormat, int iRun, Graph graph, PathList *pPaths);
+void printTextPath(char szPath[], int iLength, void *pState);
+void printCsvPath(char szPath[], int iLength, void *pState);
+void printJsonPath(char szPath[], int iLength, void *pState);
+void writeBinaryPath(char szPath[], int iLength, void *pState);
+void printCsvLabel(char cLabel);
+void printJsonLabel(char cLabel);
+void printCrashStep(Weight makespan, Weight cost, struct Data crashedM[]
+    , int iNumCrashed, void *pState);
+void printScenarioResults(int iRun, Graph graph, ScenarioResult resultM[]
+    , int iNumScenarios);
+void printVertexMask(Graph graph, uint64_t maskM[]);
+void setBinaryOutput();
+
 // prototypes to get Graph Data and Build a Graph
-int getGraphData(struct Data dataM[]);
+int getGraphData(struct Data dataM[], Crash crashM[]);
+int getScenarioData(FILE *pFile, Override overrideM[], int *piNumScenarios);
 Graph buildGraph(struct Data dataM[]);
+int loadGraph(Graph graph, struct Data dataM[]);
+uint64_t hashEdge(char cFrom, char cTo, Weight iPath);
 Graph newGraph();
-EdgeNode *allocateEdgeNode(Edge value);
-EdgeNode *insertOrderedLL(EdgeNode **pHead, Edge value);
+int internLabel(Graph graph, int iLabelM[], char cLabel);
+void countingSortEdges(int iKeyM[], int iInM[], int iOutM[], int iNumEdges, int iNumKeys);
+int linkEdgeNodes(Graph graph, EdgeNode nodeM[], int iOrderM[], int iNumEdges
+    , int iOwnerM[], int iOtherM[], struct Data dataM[], int bSuccessor);
 EdgeNode *searchLL(EdgeNode *pHead, int match, EdgeNode **ppPrecedes);
 int searchVertices(Graph graph, char cVertex);
 
 // functions in most programs, but require modifications
 void exitUsage(int iArg, char *pszMessage, char *pszDiagnosticInfo);
+void processCommandSwitches(int argc, char *argv[], Options *pOptions);
 
 // Utility routines provided by Larry (copy from program #2)
-void ErrExit(int iexitRC, char szFmt[], ...);
\ No newline at end of file
+void ErrExit(int iexitRC, char szFmt[], ...);
+#if defined(WEIGHT_DOUBLE)
+int weightEqual(Weight w1, Weight w2);
+#endif
+
+// Server requests (see runServer)
+#define REQ_LOAD            'L'
+#define REQ_UPDATE          'U'
+#define REQ_ADD             'A'
+#define REQ_REMOVE          'R'
+#define REQ_QUERY           'Q'
+#define REQ_DROP            'D'
+
+// Server limits
+#define MAX_CACHED_GRAPHS       64
+#define SERVER_RESPONSE_SIZE    (1 << 20)
+#define MAX_CONNECTIONS         64
+#define SERVER_TIMEOUT          5       // seconds to take a response
+#define SERVER_READ_SIZE        4096    // bytes read from a connection at once
+
+// A graph kept in memory by the server.  dataM is the graph's current
+// edge list; bRebuild is TRUE when ctx's graph hasn't been built from it.
+typedef struct
+{
+    int bUsed;                      // TRUE if this entry has a graph
+    uint32_t uGraphId;
+    unsigned long ulLastUse;        // for replacing the least recently used
+    int iNumData;
+    struct Data dataM[MAX_EDGES + 1];
+    int bRebuild;
+    PertContext ctx;
+} CachedGraph;
+
+// A server response being built
+typedef struct
+{
+    char *pszBuffer;                // SERVER_RESPONSE_SIZE bytes
+    int iLength;                    // bytes used
+    int bOverflow;                  // TRUE if something didn't fit
+} Response;
+
+// A client connection to the server with the request it is sending and
+// the part of a response it hasn't taken yet
+#define REQUEST_HEADER_SIZE     ((int)(1 + sizeof(uint32_t) + sizeof(uint16_t)))
+#define REQUEST_EDGE_SIZE       ((int)(2 + sizeof(Weight)))
+typedef struct
+{
+    int fd;
+    int iOffset;                    // bytes of the request received so far
+    char szHeader[REQUEST_HEADER_SIZE];     // op, graph id, number of edges
+    char szEdge[REQUEST_EDGE_SIZE];         // the edge being received
+    struct Data edgeM[MAX_EDGES + 1];
+    char szInput[SERVER_READ_SIZE]; // bytes read but not yet parsed
+    int iInputNext;                 // next of them to parse
+    int iInputEnd;
+    char *pszOutput;                // unsent part of a response (NULL if none)
+    int iOutputNext;                // next of its bytes to send
+    int iOutputEnd;
+    time_t tLastOutput;             // when some of it was last sent
+} Connection;
+
+// prototypes for the server
+int runServer(char *pszSocketPath);
+int readRequests(Connection *pConn, CachedGraph cacheM[], Response *pResponse);
+int parseRequests(Connection *pConn, CachedGraph cacheM[], Response *pResponse);
+int serveRequest(Connection *pConn, CachedGraph cacheM[], Response *pResponse);
+void handleRequest(CachedGraph cacheM[], char cOp, uint32_t uGraphId
+    , struct Data edgeM[], int iNumEdges, Response *pResponse);
+int queryCachedGraph(CachedGraph *pCached, Response *pResponse);
+CachedGraph *findCachedGraph(CachedGraph cacheM[], uint32_t uGraphId, int bCreate);
+int findCachedEdge(CachedGraph *pCached, char cFrom, char cTo);
+int checkCachedEdges(CachedGraph *pCached, char cOp, struct Data edgeM[], int iNumEdges);
+void appendResponse(Response *pResponse, void *pData, int iLength);
+void appendError(Response *pResponse, int rc, char *pszMessage);
+void appendResponsePath(char szPath[], int iLength, void *pState);
+uint32_t countResponsePaths(Response *pResponse, int iFrom);
+int sendResponse(Connection *pConn, Response *pResponse);
+int flushResponse(Connection *pConn);
+int writeAvailable(int fd, char *pData, int iLength);
+void closeConnection(Connection *pConn);
+
+// Result cache (see openResultCache)
+#define CACHE_ENTRIES       1024           // default number of graphs
+#define CACHE_MAGIC         "p6cache2"
+
+// The start of a result cache file
+typedef struct
+{
+    char szMagic[8];                // CACHE_MAGIC (not terminated)
+    char cWeightKind;               // WEIGHT_KIND of the program that made it
+    uint32_t uEntrySize;            // sizeof(CacheEntry)
+    uint32_t uNumEntries;           // number of CacheEntry after the header
+    uint64_t ullClock;              // counts uses for least recently used
+} CacheHeader;
+
+// One computed graph in a result cache file
+typedef struct
+{
+    int bUsed;                      // TRUE if the entry has a graph
+    uint64_t ullHash;               // the graph's ullEdgeHash
+    uint64_t ullLastUse;            // ullClock when last found or stored
+    int iNumVertices;
+    int iNumEdges;
+    struct Data edgeM[MAX_EDGES];   // canonicalEdges of the graph
+    char cLabelM[MAX_VERTICES];     // each vertex's label, TE and 
+    Weight teM[MAX_VERTICES];       // distance from the sinks
+    Weight sinkM[MAX_VERTICES];
+    PathList paths;                 // critical paths in the order found
+} CacheEntry;
+
+// An open result cache file
+typedef struct
+{
+    int fd;
+    size_t size;                    // bytes mapped
+    CacheHeader *pHeader;           // the mapped file
+    CacheEntry *entryM;             // its entries
+} ResultCache;
+
+// prototypes for the result cache
+int openResultCache(char *pszPath, int iNumEntries, ResultCache *pCache);
+void closeResultCache(ResultCache *pCache);
+int lookupResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths);
+void storeResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths);
+void listCriticalPaths(Graph g, PathList *pPaths);
+void appendListPath(char szPath[], int iLength, void *pState);
+int forEachListedPath(Graph g, PathList *pPaths, CriticalPathFn pfnPath, void *pState);
+int canonicalEdges(Graph g, struct Data edgeM[]);
+int compareEdgeLabels(const void *p1, const void *p2);
+
+// Out-of-core mode (see runOutOfCore)
+#define OOC_MAGIC           "p6ooc1\0\0"
+#define OOC_MEMORY_MB       64              // default memory budget (-m)
+#define OOC_BLOCK_SIZE      (64 * 1024)     // bytes a stream reads or writes at once
+#define OOC_NO_LEVEL        UINT32_MAX      // level of a vertex not reached yet
+#define OOC_MAX_ID          (UINT32_MAX - 1)
+#define OOC_MESSAGE_SIZE    100
+
+// An edge from the input (sorted by FROM vertex or by TO vertex)
+typedef struct
+{
+    uint32_t uFrom;
+    uint32_t uTo;
+    Weight weight;
+} OocEdge;
+
+// An edge with the topological level of its FROM vertex
+typedef struct
+{
+    uint32_t uLevel;
+    uint32_t uFrom;
+    uint32_t uTo;
+    Weight weight;
+} OocLevelEdge;
+
+// A vertex's record in the vertex file.  uInDegree counts the predecessors
+// not placed in a level yet.
+typedef struct
+{
+    uint32_t uInDegree;
+    uint32_t uLevel;                // OOC_NO_LEVEL until it is placed
+    Weight te;
+    Weight sink;                    // distance to the sinks
+} OocVertex;
+
+// A new TE or distance to the sinks for a vertex
+typedef struct
+{
+    uint32_t uVertex;
+    Weight value;
+} OocUpdate;
+
+// The start of an out-of-core result file
+typedef struct
+{
+    char szMagic[8];                // OOC_MAGIC
+    char cWeightKind;               // WEIGHT_KIND of the program that made it
+    uint64_t ullNumVertices;        // number of OocResult after the header
+    Weight maxTE;
+} OocHeader;
+
+// One vertex's result, in vertex id order after the OocHeader
+typedef struct
+{
+    Weight te;
+    Weight tl;
+    Weight slack;
+} OocResult;
+
+// A buffered reader or writer of fixed size records in a file
+typedef struct
+{
+    int fd;
+    char *pBuffer;
+    size_t size;                    // bytes of pBuffer (whole records)
+    size_t iNext;                   // next byte of pBuffer to read or write
+    size_t iEnd;                    // bytes of pBuffer read from the file
+    off_t offset;                   // file offset after pBuffer's bytes
+    off_t end;                      // where reading stops
+} OocStream;
+
+// An out-of-core run
+typedef struct
+{
+    char *pArena;                   // the memory budget less pWindow's
+    size_t size;                    // bytes of pArena
+    size_t windowSize;              // bytes of the result file mapped at once
+    uint32_t uNumVertices;          // largest vertex id + 1
+    uint64_t ullNumEdges;
+    uint32_t uNumLevels;
+    Weight maxTE;
+    int fdEdge;                     // OocEdge sorted by FROM vertex
+    int fdFirst;                    // uint64_t first edge of each vertex
+    int fdVertex;                   // OocVertex for each vertex id
+    int fdLevel;                    // OocLevelEdge sorted by level
+    char szMessage[OOC_MESSAGE_SIZE];   // why the run failed
+} OocRun;
+
+// The part of a file being written through a memory mapping
+typedef struct
+{
+    int fd;
+    off_t size;                     // bytes in the file
+    size_t windowSize;              // bytes mapped at once (whole pages)
+    char *pWindow;                  // the mapped bytes (NULL if none)
+    off_t start;                    // file offset of pWindow
+    size_t length;                  // bytes mapped
+    off_t next;                     // file offset of the next byte to write
+} OocMap;
+
+// prototypes for out-of-core mode
+int runOutOfCore(char *pszResultPath, int iMemoryMB, char szMessage[]);
+int readOocEdges(OocRun *pRun, FILE *pFile, int fdOut);
+int sortOocFile(OocRun *pRun, int fdIn, uint64_t ullNumRecords, size_t recordSize
+    , int (*pfnCompare)(const void *, const void *), int *pfdOut);
+int mergeOocRuns(int fdIn, int fdOut, uint64_t ullFirst, uint64_t ullRunLength
+    , int iNumRuns, uint64_t ullNumRecords, size_t recordSize
+    , int (*pfnCompare)(const void *, const void *), char *pBuffer, size_t blockSize);
+int makeOocVertices(OocRun *pRun, int fdByTo, int fdQueue, uint64_t *pullNumSources);
+int levelOocVertices(OocRun *pRun, int fdQueue, uint64_t ullNumSources, int fdOut);
+int applyOocDecrements(OocRun *pRun, uint32_t uVertexM[], size_t iNum, uint32_t uLevel
+    , OocStream *pQueue, uint64_t *pullNumQueued);
+int forwardOocPass(OocRun *pRun);
+int backwardOocPass(OocRun *pRun);
+int applyOocUpdates(OocRun *pRun, OocUpdate updateM[], size_t iNum, int bSink);
+int writeOocResults(OocRun *pRun, char *pszResultPath);
+int writeOocMapped(OocMap *pMap, void *pData, size_t size);
+int openOocTemp();
+void openOocStream(OocStream *pStream, int fd, off_t offset, off_t end
+    , char *pBuffer, size_t size, size_t recordSize);
+int readOocRecord(OocStream *pStream, void *pRecord, size_t recordSize);
+int writeOocRecord(OocStream *pStream, void *pRecord, size_t recordSize);
+int flushOocStream(OocStream *pStream);
+int readOocAt(int fd, void *pData, size_t size, off_t offset);
+int writeOocAt(int fd, void *pData, size_t size, off_t offset);
+int compareOocFrom(const void *p1, const void *p2);
+int compareOocTo(const void *p1, const void *p2);
+int compareOocLevel(const void *p1, const void *p2);
+int compareOocUpdates(const void *p1, const void *p2);
+int compareOocIds(const void *p1, const void *p2);
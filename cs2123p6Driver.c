@@ -5,12 +5,34 @@ Purpose:
    the critical paths in accordance with PERT (Program Evaluation 
    and Review Technique) standards.
 Command Parameters:
-   There are no command parameters.  This program uses files redirected
-   from stdin.  
+   p6 [-f text|csv|jsonl|bin] [-t] [-c cacheFile [-n entries]] [-k] 
+      [-w scenarioFile] < inputFile
+   p6 -s socketPath
+   p6 -x resultFile [-m megabytes] < edgeFile
+   -f   output format (see writeResults).  The default is text.
+   -t   remove redundant edges before computing (see removeRedundantEdges)
+   -s   instead of reading stdin, serve requests on a Unix domain socket
+        (see runServer)
+   -c   reuse the TE, TL and critical paths of identical graphs from
+        earlier runs kept in cacheFile (see openResultCache)
+   -n   number of graphs a new cacheFile can hold
+   -k   also print the least cost way to shorten each project one unit at
+        a time (see pertCrash).  Only for -f text and not with -t.
+   -w   also print the makespan and the changes to the critical vertices
+        of each what-if scenario in scenarioFile (see getScenarioData and
+        pertEvaluateScenarios).  Only for -f text.
+   -x   compute one graph too large for memory, read as "from to weight"
+        lines with integer vertex ids, and write each vertex's TE, TL and
+        slack to resultFile (see runOutOfCore)
+   -m   megabytes of memory -x can use.  The default is 64.
+   This program uses files redirected from stdin.  
 Input:
    Data will contain multiple sets of edges (one set for each graph)
    From To PathWeight
    %c   %c    %d
+   With -k, an edge that can be shortened also has the shortest its path
+   weight can be and the cost of shortening it by 1:
+   From To PathWeight CrashWeight CostSlope
    Each set of edges is terminated by a record having 0 0 0
    Example input:
    A B 5
@@ -60,43 +82,42 @@ Notes:
 **********************************************************************/
 
 #define _CRT_SECURE_NO_WARNINGS 1
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
 
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#endif
 #include "cs2123p6.h"
-/********************************** freeLL ***********************************************
-void freeLL(EdgeNode *edge)
-Purpose:
-    Recursively traverses linked list and frees each node.
-Parameters:
-    I  EdgeNode *edge                  Pointer to an EdgeNode
-Notes:
-    Recursively traverses linked list of EdgeNodes until there are no more (i.e., NULL).
-    Once NULL, the function will return and free each EdgeNode in the linked list. 
-Returns:
-    N/A
-*******************************************************************************************/
-void freeLL(EdgeNode *edge)
-{
-	if (edge == NULL)
-		return;
-	freeLL(edge->pNextEdge);
-	free(edge);
-}
 /********************************** freeGraph *******************************************
 void freeGraph(Graph g)
 Purpose:
-    Iteratively goes through vertexM[] freeing each successorList and predecessorList
-    linked list.  
+    Frees the graph.
 Parameters:
     I  Graph g                  Pointer to a graphImp
 Notes:
-    For each vertexM it passes a pointer to an EdgeNode to freeLL which frees both of 
-    the current vertexM's linked lists (successorList and predecessorList).  When 
-    finished each linked list is set to NULL to prevent a dangling reference.  
-    Lastly, it frees the graph (i.e., the entire vertexM[]). 
+    The successorList and predecessorList EdgeNodes live in g->edgeNodeM (see 
+    buildGraph), so they are released along with the graph itself.  Each list is
+    still set to NULL to prevent a dangling reference.
 Returns:
     N/A
 *******************************************************************************************/
@@ -105,102 +126,103 @@ void freeGraph(Graph g)
 	int i;     // index for vertexM 
 	for (i = 0; i < g->iNumVertices; i++)
 	{
-		freeLL(g->vertexM[i].successorList);
 		g->vertexM[i].successorList = NULL;
-		freeLL(g->vertexM[i].predecessorList);	
 		g->vertexM[i].predecessorList = NULL;
 	}
 	free(g);
 }
-/************************** depthFirstPrintCriticalPaths ***********************************
-void depthFirstPrintCriticalPaths(Graph g, int v, char szCriticalPath[], int iIndex)
+/************************** depthFirstCriticalPaths ***********************************
+void depthFirstCriticalPaths(Graph g, int v, char szCriticalPath[], int iIndex
+    , CriticalPathFn pfnPath, void *pState)
 Purpose:
-    Prints the critical path(s) of graph.
+    Finds the critical path(s) of graph starting at a vertex.
 Parameters:
     I  Graph g                  Pointer to a graphImp
     I  int v                    Index for vertedM[]
-    O  char szCriticalPath[]    Stores critical paths
+    O  char szCriticalPath[]    Stores the labels of the critical path
     I  int iIndex               Index of szCriticalPath[]
+    I  CriticalPathFn pfnPath   Function called with each critical path
+    I  void *pState             Passed to pfnPath
 Notes:
-    Called by printCriticalPaths to traverse double adjacency list searching for critical
-    path(s).  Uses a depth first traversal.  If function traverses to a vertex that does
-    not have equivalent values of iMaxFromSource and iTL it will stop traversing that path.
-    When a sink is found the contents of the szCriticalPath array are printed along with 
-    the sink, the function then returns back to check for other critical paths.    
+    Called by forEachCriticalPath to traverse double adjacency list searching for critical
+    path(s).  Uses a depth first traversal.  It only traverses an edge if isCriticalEdge
+    (the vertex it reaches has equivalent values of iMaxFromSource and iTL and the edge
+    has no slack).  When a sink is found the labels in szCriticalPath along with the 
+    sink are passed to pfnPath, the function then returns back to check for other 
+    critical paths.    
 Returns:
     N/A
 *******************************************************************************************/
-void depthFirstPrintCriticalPaths(Graph g, int v, char szCriticalPath[], int iIndex)
+void depthFirstCriticalPaths(Graph g, int v, char szCriticalPath[], int iIndex
+    , CriticalPathFn pfnPath, void *pState)
 {
 	EdgeNode *e;
-	if (g->vertexM[v].iMaxFromSource != g->vertexM[v].iTL)
-		return;
+	szCriticalPath[iIndex++] = g->vertexM[v].cLabel;   // add char to string and increment index
+	szCriticalPath[iIndex] = '\0';                     // add NULL byte
 	if (g->vertexM[v].successorList == NULL)
 	{
-		printf("%s", szCriticalPath);
-		printf("%c\n", g->vertexM[v].cLabel);
+		pfnPath(szCriticalPath, iIndex, pState);
 		return;
 	}
-	szCriticalPath[iIndex++] = g->vertexM[v].cLabel;   // add char to string and increment index
-	szCriticalPath[iIndex++] = ' ';                    // include space after char and increment index
-	szCriticalPath[iIndex] = '\0';                     // add NULL byte
 	for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
 	{
-	 depthFirstPrintCriticalPaths(g, e->edge.iVertex, szCriticalPath, iIndex);	
+		if (isCriticalEdge(g, v, e->edge))
+			depthFirstCriticalPaths(g, e->edge.iVertex, szCriticalPath, iIndex, pfnPath, pState);	
 	}
 }
-/************************** printCriticalPaths ***********************************
-void printCriticalPaths(Graph g)
+/************************** forEachCriticalPath ***********************************
+int forEachCriticalPath(Graph g, CriticalPathFn pfnPath, void *pState)
 Purpose:
-    Prints the critical path(s) of graph.
+    Calls a function with each critical path of graph.
 Parameters:
     I  Graph g              Pointer to a graphImp
+    I  CriticalPathFn pfnPath  Function called with each critical path
+    I  void *pState         Passed to pfnPath
 Notes:
-    Calls depthFirstPrintCriticalPaths for each source in graph that is part of
+    Calls depthFirstCriticalPaths for each source in graph that is part of
     a critical path.  
 Returns:
-    N/A
+    PERT_OK - the paths were found.
+    ERR_ALGORITHM - the graph doesn't have a source.
 **********************************************************************************/
-void printCriticalPaths(Graph g)
+int forEachCriticalPath(Graph g, CriticalPathFn pfnPath, void *pState)
 {
 	int iNumSources;            // stores total number of
 	                            // sources in graph
 	int i;                      // index of vertexM array
 	int iSourceM[MAX_VERTICES];
-	char szCriticalPath[MAX_VERTICES];
+	char szCriticalPath[MAX_VERTICES + 1];
 	iNumSources = findSources(g, iSourceM);
 	if (iNumSources <= 0)
-		ErrExit(ERR_ALGORITHM, "number of sources returned is 0");
-	printf("Critical Path(s)\n");
+		return ERR_ALGORITHM;
 	for (i = 0; i < iNumSources; i++)
 	{ 
-		if (g->vertexM[iSourceM[i]].iMaxFromSource == g->vertexM[iSourceM[i]].iTL)
-		    depthFirstPrintCriticalPaths(g, iSourceM[i], szCriticalPath, 0);
+		if (WEIGHT_EQUAL(g->vertexM[iSourceM[i]].iMaxFromSource, g->vertexM[iSourceM[i]].iTL))
+		    depthFirstCriticalPaths(g, iSourceM[i], szCriticalPath, 0, pfnPath, pState);
 	}
+	return PERT_OK;
 }
-/************************** updateTL ****************************************
-void updateTL(Graph g, int maximumTE)
+/************************** printCriticalPaths ***********************************
+void printCriticalPaths(Graph g)
 Purpose:
-    Computes the TL for each vertex in vertexM[].
+    Prints the critical path(s) of graph.
 Parameters:
     I  Graph g              Pointer to a graphImp
-    I  int maximumTE        Integer value of largest TE in graph
 Notes:
-    TE is calculated by subtracting the maximum TE from the maximum distance
-    from sink.
+    Uses forEachCriticalPath with printTextPath.  
 Returns:
     N/A
 **********************************************************************************/
-void updateTL(Graph g, int maximumTE)
+void printCriticalPaths(Graph g)
 {
-	int i;            // index of vertexM array
-	for (i = 0; i < g->iNumVertices; i++)
-	{
-		g->vertexM[i].iTL = maximumTE - g->vertexM[i].iMaxFromSink;
-	}
+	int iSourceM[MAX_VERTICES];
+	if (findSources(g, iSourceM) <= 0)
+		ErrExit(ERR_ALGORITHM, "number of sources returned is 0");
+	printf("Critical Path(s)\n");
+	forEachCriticalPath(g, printTextPath, NULL);
 }
 /************************** findMaxTE ****************************************
-int findMaxTE(Graph g)
+Weight findMaxTE(Graph g)
 Purpose:
     Searches for maximum TE in graph.
 Parameters:
@@ -211,10 +233,10 @@ Notes:
 Returns:
     Returns the largest TE in graph.
 **********************************************************************************/
-int findMaxTE(Graph g)
+Weight findMaxTE(Graph g)
 {
 	int i;                    // index of vertexM array
-	int max = -9999;          // will store the largest
+	Weight max = WEIGHT_MIN;  // will store the largest
 	                          // iMaxFromSource value from graph
 	for (i = 0; i < g->iNumVertices; i++)
 	{
@@ -223,138 +245,33 @@ int findMaxTE(Graph g)
 	}
 	return max;
 }
-/******************** computeMaxDistFromSink ****************************************
-void computeMaxDistFromSink(Graph g, int v, int iPathLength)
+#if defined(WEIGHT_DOUBLE)
+/************************** weightEqual ****************************************
+int weightEqual(Weight w1, Weight w2)
 Purpose:
-    Takes a source from a graph and uses a depth first traversal to 
-    compute the maximum distance of each vertex from each sink.
+    Determines whether two double weights are equal within WEIGHT_EPSILON.
 Parameters:
-    I  Graph g              Pointer to a graphImp
-    I  int v                Integer value corresponding to a vertex
-    I  int iPathLength      Integer value that stores current path length
-                            between nodes
-Notes:
-    This function recursively traverses the graph using a depth first
-    traversal approach.  It will update iMaxfromSource for each vertex
-    in the graph.  Will visit a node and then using a for loop traverse to the
-    next successor and continue this pattern until NULL.  If the value of the
-    successors iMaxFromSource is less than the current nodes iMaxFromSource +
-    the successors iPath (distance) then the successors iMaxFromSource is 
-    changed to the higher value.
-Returns:
-    N/A
-**********************************************************************************/
-void computeMaxDistFromSink(Graph g, int v, int iPathLength)
-{
-	EdgeNode *e;
-	for (e = g->vertexM[v].predecessorList; e != NULL; e = e->pNextEdge)
-	{
-		if (g->vertexM[e->edge.iVertex].iMaxFromSink < (g->vertexM[v].iMaxFromSink + e->edge.iPath))
-			g->vertexM[e->edge.iVertex].iMaxFromSink = g->vertexM[v].iMaxFromSink + e->edge.iPath;
-		computeMaxDistFromSink(g, e->edge.iVertex, e->edge.iPath);
-	}
-}
-/******************** findSinks **************************************
-int findSources(Graph g, int iSinkM[])
-Purpose:
-    Searches through graph for the sink vertices. 
-Parameters:
-    I  Graph g            Pointer to a graphImp
-    O  int iSinkM[]       Array of integers used to hold index of sink
-                          vertices
-Notes:
-    Each graph contains an array of Vertex structures.  This function
-    iteratively searches through this array seeking vertices that do not
-    have successors.  This function assumes that vertex without successors 
-    is a sink vertex.  After iNumVertices - 1 iterations, the integer value
-    'j' is returned to the calling function.  If j = 0, something is not right.
-Returns:
-    Functionally:
-           j            - integer of total number of sinks in graph
-    Via parameters:
-           iSinkM       - array that stores indexes of sink vertices 
-                          from graph
-**************************************************************************/
-int findSinks(Graph g, int iSinkM[])
-{
-	int i;                 // index used by for loop
-	int j = 0;             // index used for iSinkM       
-	for (i = 0; i < g->iNumVertices; i++)
-	{
-		if (g->vertexM[i].successorList == NULL)
-		{  
-			iSinkM[j] = i;    // assign source indexes
-			j++;
-		}
-	} // end for
-	return j; // should be total number of sinks in graph
-}
-/******************** maxDistFromSink **************************************
-void maxDistFromSink(Graph g)
-Purpose:
-    Computes the maximum distances from sinks in graph. 
-Parameters:
-    I  Graph g              Pointer to a graphImp
+    I  Weight w1            First weight
+    I  Weight w2            Second weight
 Notes:
-    This function calls findSinks which returns the number of sinks and
-    an array of indexes corresponding to the sink vertices.  This function
-    then calls a function which computes the maximum distances from each 
-    sink to each vertex in the graph.  If the current maximum distance is
-    greater than the new maximum distance, current maximum distance is
-    kept and the traversal along this path stops.  If the current maximum
-    distance is less than the new maximum distance, the new maximum distance
-    replaces the old maximum distance and the path is traversed until NULL or
-    a current maximum distance is greater.
+    The tolerance is relative to the larger magnitude (but at least 1) since 
+    TE and TL of the same vertex are sums taken along different paths and
+    can differ in the last few bits.
 Returns:
-    This function does not return anything but it does update the each 
-    iMaxFromSink distance for each vertex in the graph.
-**************************************************************************/
-void maxDistFromSink(Graph g)
-{
-	int iSinkM[MAX_VERTICES];                        // used to store indexes of sources
-	int iNumSinks;                                   // number of sources found in g
-	int i;
-	memset(iSinkM, -1, MAX_VERTICES*sizeof(int));    // initialize array to -1 
-	                                                 //  -1 indicates that current array element is not source
-	iNumSinks = findSinks(g, iSinkM);
-	if (iNumSinks <= 0)
-		ErrExit(ERR_ALGORITHM, "number of sinks returned is 0");
-    for (i = 0; i < iNumSinks; i++)
-	{   // initial call starts with sources, path length must be 0
-		computeMaxDistFromSink(g, iSinkM[i], 0);
-	}
-}
-/******************** computeMaxDistFromSource **************************************
-void computeMaxDistFromSource(Graph g, int v, int iPathLength)
-Purpose:
-    Takes a source from a graph and uses a depth first traversal to 
-    compute the maximum distance of each vertex from each source.
-Parameters:
-    I  Graph g              Pointer to a graphImp
-    I  int v                Integer value corresponding to a vertex
-    I  int iPathLength      Integer value that stores current path length
-                            between nodes
-Notes:
-    This function recursively traverses the graph using a depth first
-    traversal approach.  It will update iMaxfromSource for each vertex
-    in the graph.  Will visit a node and then using a for loop traverse to the
-    next successor and continue this pattern until NULL.  If the value of the
-    successors iMaxFromSource is less than the current nodes iMaxFromSource +
-    the successors iPath (distance) then the successors iMaxFromSource is 
-    changed to the higher value.
-Returns:
-    N/A
+    TRUE - the weights are equal within the tolerance
+    FALSE - they aren't
 **********************************************************************************/
-void computeMaxDistFromSource(Graph g, int v, int iPathLength)
+int weightEqual(Weight w1, Weight w2)
 {
-	EdgeNode *e;
-	for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
-	{
-		if (g->vertexM[e->edge.iVertex].iMaxFromSource < (g->vertexM[v].iMaxFromSource + e->edge.iPath))
-			g->vertexM[e->edge.iVertex].iMaxFromSource = g->vertexM[v].iMaxFromSource + e->edge.iPath;
-		computeMaxDistFromSource(g, e->edge.iVertex, e->edge.iPath);
-	}
+	Weight diff = w1 > w2 ? w1 - w2 : w2 - w1;
+	Weight scale = 1.0;
+	if (w1 > scale || -w1 > scale)
+		scale = w1 > 0 ? w1 : -w1;
+	if (w2 > scale || -w2 > scale)
+		scale = w2 > 0 ? w2 : -w2;
+	return diff <= WEIGHT_EPSILON * scale;
 }
+#endif
 /******************** findSources **************************************
 int findSources(Graph g, int iSourceM[])
 Purpose:
@@ -390,312 +307,4895 @@ int findSources(Graph g, int iSourceM[])
 	} // end for
 	return j; // should be total number of sources in graph
 }
-/******************** maxDistFromSource **************************************
-void maxDistFromSource(Graph g)
+/************************** computePertTEAndTL ***********************************
+int computePertTEAndTL(Graph graph)
 Purpose:
-    Computes the maximum distances from sources in graph. 
+    Computes the TE (iMaxFromSource) and TL of each vertex in the graph.
 Parameters:
-    I  Graph g              Pointer to a graphImp
+    I/O Graph graph         Pointer to a graphImp
 Notes:
-    This program calls findSources to locate each source in graph (i.e.,
-    vertices without any predecessors).  The function findSources returns
-    the number of sources found and through a parameter an array of indexes
-    corresponding to these sources.  After the sources have been identified
-    this function uses a for loop to send each source into a depth first 
-    traversal function to calculate the maximum distances from each source
-    to each vertex.
+    Doesn't print or exit, so it can be used by the library functions.
+    Graphs with at most SMALL_GRAPH_VERTICES vertices are done by 
+    computePertSmall.  Larger ones are first reduced by reduceGraph; if that
+    removes any vertices, the reduced graph is computed (by calling this
+    function again) and the results are expanded by expandReducedGraph.
+    Otherwise, it uses computePertLevels.
 Returns:
-    This function updates the graph's vertices with maximum distances from
-    the source vertices.  Aside from this the function does not return
-    anything (well, maybe some bugs:-D).
-**************************************************************************/
-void maxDistFromSource(Graph g)
+    PERT_OK - TE and TL were computed.
+    ERR_ALGORITHM - the graph doesn't have a source or a sink.
+    ERR_BAD_INPUT - the graph has a cycle.
+**********************************************************************************/
+int computePertTEAndTL(Graph graph)
 {
-	int iSourceM[MAX_VERTICES];                        // used to store indexes of sources
-	int iNumSources;                                   // number of sources found in g
-	int i;
-	iNumSources = findSources(g, iSourceM);
-	if (iNumSources <= 0)
-		ErrExit(ERR_ALGORITHM, "number of sources returned is 0");
-    for (i = 0; i < iNumSources; i++)
-	{   // initial call starts with sources, path length must be 0
-		computeMaxDistFromSource(g, iSourceM[i], 0);
+	int rc;                 // return code from reduceGraph
+	ReducedGraph reduced;   // graph with its chains contracted
+	if (graph->iNumVertices <= SMALL_GRAPH_VERTICES)
+		return computePertSmall(graph);
+	rc = reduceGraph(graph, &reduced);
+	if (rc != PERT_OK)
+		return rc;
+	if (reduced.graph.iNumVertices < graph->iNumVertices)
+	{
+		rc = computePertTEAndTL(&reduced.graph);
+		if (rc != PERT_OK)
+			return rc;
+		expandReducedGraph(graph, &reduced);
+		return PERT_OK;
 	}
+	return computePertLevels(graph);
 }
-void computePertTEAndTL(Graph graph)
+/************************** computePertLevels ***********************************
+int computePertLevels(Graph graph)
+Purpose:
+    Computes the TE and TL of each vertex in a graph of any size by 
+    streaming its edges in order of topological level.
+Parameters:
+    I/O Graph graph         Pointer to a graphImp
+Notes:
+    A vertex's level is one more than the highest level of its 
+    predecessors (sources are level 0).  The edges are copied out of the 
+    successor lists into one array sorted by the level of their FROM vertex
+    (a counting sort), so every edge into a vertex comes before every edge
+    out of it.  TE is then one sequential pass over the array and the 
+    distance from the sinks is one pass over it backwards, so each edge is
+    visited twice and the passes don't chase the lists.  runOutOfCore does
+    the same for graphs larger than memory with the edges and vertices in
+    files.
+Returns:
+    PERT_OK - TE and TL were computed.
+    ERR_ALGORITHM - the graph doesn't have a source or a sink.
+    ERR_BAD_INPUT - the graph has a cycle.
+**********************************************************************************/
+int computePertLevels(Graph graph)
 {
-	int maxTE;              // store largest iMaxFromSource 
-	                        // (i.e., max TE) value found in graph
-	maxDistFromSource(graph);
-	maxDistFromSink(graph);
-    maxTE = findMaxTE(graph);
-    updateTL(graph, maxTE);
-}
-/* end of p6 student written functions */
-// dataM has the edges from the data
-struct Data dataM[MAX_EDGES];
+	int iOrderM[MAX_VERTICES];          // vertices in topological order
+	int iLevelM[MAX_VERTICES];          // topological level of each vertex
+	int iStartM[MAX_VERTICES + 1];      // first edge of each level in edgeM
+	Edge edgeM[MAX_EDGES];              // edges by level (iVertex is TO)
+	int iFromM[MAX_EDGES];              // FROM vertex of each edge
+	Weight teM[MAX_VERTICES];           // iMaxFromSource
+	Weight sinkM[MAX_VERTICES];         // iMaxFromSink
+	Weight maxTE = WEIGHT_MIN;
+	int iNumLevels = 0;
+	int bHasSink = FALSE;
+	int i;
+	int v;
+	EdgeNode *e;
+	int n = graph->iNumVertices;
+
+	if (topologicalOrder(graph, iOrderM) < n)
+		return ERR_BAD_INPUT;
+	for (v = 0; v < n; v++)
+	{
+		iLevelM[v] = 0;
+		teM[v] = 0;
+		sinkM[v] = 0;
+		if (graph->vertexM[v].successorList == NULL)
+			bHasSink = TRUE;
+	}
+	if (n == 0 || !bHasSink)
+		return ERR_ALGORITHM;
+
+	// levels and the number of edges from each level
+	memset(iStartM, 0, sizeof(iStartM));
+	for (i = 0; i < n; i++)
+	{
+		v = iOrderM[i];
+		if (iLevelM[v] >= iNumLevels)
+			iNumLevels = iLevelM[v] + 1;
+		for (e = graph->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			if (iLevelM[e->edge.iVertex] <= iLevelM[v])
+				iLevelM[e->edge.iVertex] = iLevelM[v] + 1;
+			iStartM[iLevelM[v] + 1]++;
+		}
+	}
+	for (i = 1; i <= iNumLevels; i++)
+		iStartM[i] += iStartM[i - 1];
+	for (v = 0; v < n; v++)
+	{
+		for (e = graph->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			iFromM[iStartM[iLevelM[v]]] = v;
+			edgeM[iStartM[iLevelM[v]]++] = e->edge;
+		}
+	}
+	// iStartM[level] is now the end of that level, so iStartM[iNumLevels - 1]
+	// is the number of edges
 
-int main()
+	// TE in level order
+	for (i = 0; i < iStartM[iNumLevels - 1]; i++)
+	{
+		if (teM[edgeM[i].iVertex] < teM[iFromM[i]] + edgeM[i].iPath)
+			teM[edgeM[i].iVertex] = teM[iFromM[i]] + edgeM[i].iPath;
+	}
+	// distance from the sinks in reverse level order
+	for (i = iStartM[iNumLevels - 1] - 1; i >= 0; i--)
+	{
+		if (sinkM[iFromM[i]] < sinkM[edgeM[i].iVertex] + edgeM[i].iPath)
+			sinkM[iFromM[i]] = sinkM[edgeM[i].iVertex] + edgeM[i].iPath;
+	}
+	for (v = 0; v < n; v++)
+	{
+		if (teM[v] > maxTE)
+			maxTE = teM[v];
+	}
+	for (v = 0; v < n; v++)
+	{
+		graph->vertexM[v].iMaxFromSource = teM[v];
+		graph->vertexM[v].iMaxFromSink = sinkM[v];
+		graph->vertexM[v].iTL = maxTE - sinkM[v];
+	}
+	return PERT_OK;
+}
+/************************** reduceGraph ***********************************
+int reduceGraph(Graph graph, ReducedGraph *pReduced)
+Purpose:
+    Builds a smaller graph having the same TE and TL by contracting chains
+    of vertices that have exactly one predecessor and one successor.
+Parameters:
+    I  Graph graph          Pointer to a graphImp
+    O  ReducedGraph *pReduced  The reduced graph and what is needed to
+                            expand its results back onto graph.
+Notes:
+    A vertex with one predecessor and one successor (an interior vertex)
+    can't change which path is longest, so it is dropped.  Starting from
+    each successor edge of each remaining vertex, the chain of interior
+    vertices is followed to the next remaining vertex and replaced by a 
+    single edge whose weight is the chain's length.  If that makes parallel
+    edges, the longest one is kept.  Each interior vertex remembers the 
+    chain's ends and its distance from each of them.
+    The reduced graph labels its vertices 1, 2, ... (a subscript of 
+    iKeptM plus 1).
+    An interior vertex can only be reached through its chain, so an 
+    interior vertex not found that way is on a cycle.
+Returns:
+    PERT_OK - the graph was reduced.
+    ERR_BAD_INPUT - the graph has a cycle of interior vertices.
+**********************************************************************************/
+int reduceGraph(Graph graph, ReducedGraph *pReduced)
 {
-    int iRun = 0;
-    Graph graph;
-    while (getGraphData(dataM) == TRUE)
-    {
-        // Build the graph from the dataM array
-        graph = buildGraph(dataM);
-        iRun++;
-        printGraph(iRun, "Initial", graph);
+	struct Data dataM[MAX_EDGES + 1];   // edges of the reduced graph
+	int iNumData = 0;
+	int iReducedM[MAX_VERTICES];        // reduced graph label of each kept vertex
+	int iEdgeToM[MAX_VERTICES];         // dataM subscript of the edge from the 
+	                                    // current kept vertex to each vertex
+	int iChainM[MAX_VERTICES];          // interior vertices on the current chain
+	int iChainLength;
+	int iNumKept = 0;
+	int iNumInterior = 0;               // number of interior vertices
+	int iNumVisited = 0;                // interior vertices found on chains
+	int k;
+	int i;
+	int u;
+	int v;
+	Weight length;                      // length of the chain so far
+	EdgeNode *e;
+	Vertex *pVertex;
 
-        // Compute TE and TL
-        computePertTEAndTL(graph);
-        printGraph(iRun, "PERT TE and TL", graph);
+	for (v = 0; v < graph->iNumVertices; v++)
+	{
+		pVertex = &graph->vertexM[v];
+		iEdgeToM[v] = -1;
+		if (pVertex->successorList != NULL && pVertex->successorList->pNextEdge == NULL
+			&& pVertex->predecessorList != NULL && pVertex->predecessorList->pNextEdge == NULL)
+		{   // interior vertex
+			pReduced->iHeadM[v] = -1;
+			iNumInterior++;
+			continue;
+		}
+		pReduced->iHeadM[v] = v;        // kept vertices are their own head
+		iReducedM[v] = iNumKept + 1;
+		pReduced->iKeptM[iNumKept++] = v;
+	}
 
-        // Print critical paths
-        printCriticalPaths(graph);
-        printf("\n");
+	for (k = 0; k < iNumKept; k++)
+	{
+		u = pReduced->iKeptM[k];
+		for (e = graph->vertexM[u].successorList; e != NULL; e = e->pNextEdge)
+		{
+			// follow the chain to a kept vertex
+			v = e->edge.iVertex;
+			length = e->edge.iPath;
+			iChainLength = 0;
+			while (pReduced->iHeadM[v] != v)
+			{
+				pReduced->iHeadM[v] = u;
+				pReduced->offsetM[v] = length;
+				iChainM[iChainLength++] = v;
+				length += graph->vertexM[v].successorList->edge.iPath;
+				v = graph->vertexM[v].successorList->edge.iVertex;
+			}
+			for (i = 0; i < iChainLength; i++)
+			{
+				pReduced->iTailM[iChainM[i]] = v;
+				pReduced->restM[iChainM[i]] = length - pReduced->offsetM[iChainM[i]];
+			}
+			iNumVisited += iChainLength;
 
-        // free the graph
-        freeGraph(graph);
-    }
-    return 0;
+			// add the edge or keep the longer of the parallel edges
+			if (iEdgeToM[v] >= 0 && dataM[iEdgeToM[v]].cFrom == (char)iReducedM[u])
+			{
+				if (dataM[iEdgeToM[v]].iPath < length)
+					dataM[iEdgeToM[v]].iPath = length;
+				continue;
+			}
+			iEdgeToM[v] = iNumData;
+			dataM[iNumData].cFrom = (char)iReducedM[u];
+			dataM[iNumData].cTo = (char)iReducedM[v];
+			dataM[iNumData].iPath = length;
+			iNumData++;
+		}
+	}
+	if (iNumVisited < iNumInterior)
+		return ERR_BAD_INPUT;
+	dataM[iNumData].cFrom = '\0';
+	memset(pReduced->graph.vertexM, '\0', sizeof(Vertex)*iNumKept);
+	pReduced->graph.iNumVertices = 0;
+	return loadGraph(&pReduced->graph, dataM);
 }
-/******************** getGraphData **************************************
-  int getGraphData(struct Data dataM[])
+/************************** expandReducedGraph ***********************************
+void expandReducedGraph(Graph graph, ReducedGraph *pReduced)
 Purpose:
-    Populates an array of edges with data from stdin.  The array is 
-    terminated when EOF or a 0 0 0 is encountered in the data. 
+    Sets the TE and TL of each vertex of a graph from the results computed
+    for its reduced graph.
 Parameters:
-    O   struct Data dataM[]     An array of edges (to, from, path weight)
+    I/O Graph graph         Pointer to a graphImp
+    I  ReducedGraph *pReduced  Its reduced graph (from reduceGraph) with TE
+                            and TL computed.
 Notes:
-    - The array of edges is terminated by an edge having a from vertex
-      equal to the character '0'.
+    An interior vertex is only reached through its chain and can only 
+    reach the sinks through its chain, so its TE is its chain head's TE
+    plus its offset, and its distance from the sinks is the chain tail's
+    plus the rest of the chain.
 Returns:
-    TRUE - data was read to populate the array of vertices.
-    FALSE - no data found.
-**************************************************************************/
-int getGraphData(struct Data dataM[])
+    N/A
+**********************************************************************************/
+void expandReducedGraph(Graph graph, ReducedGraph *pReduced)
 {
-    char szInput[100];
-    int i = 0;
-    int iScanfCnt;
-    while (fgets(szInput, 50, stdin) != NULL)
-    {
-        if (i > MAX_EDGES)
-            ErrExit(ERR_BAD_INPUT, "too many edges");
-        iScanfCnt = sscanf(szInput, "%c %c %d"
-            , &dataM[i].cFrom, &dataM[i].cTo, &dataM[i].iPath);
-        if (iScanfCnt < 3)
-            ErrExit(ERR_BAD_INPUT, " Found: '%s', scanf count is %d", szInput, iScanfCnt);
-        if (dataM[i].cFrom == '0')
-        {
-            dataM[i].cFrom = '\0';
-            break;
-        }
-        i++;
-    }
-    return i > 0;
+	int r;
+	int v;
+	Vertex *pFrom;
+	Vertex *pTo;
+	for (r = 0; r < pReduced->graph.iNumVertices; r++)
+	{
+		pFrom = &pReduced->graph.vertexM[r];
+		pTo = &graph->vertexM[pReduced->iKeptM[(unsigned char)pFrom->cLabel - 1]];
+		pTo->iMaxFromSource = pFrom->iMaxFromSource;
+		pTo->iMaxFromSink = pFrom->iMaxFromSink;
+		pTo->iTL = pFrom->iTL;
+	}
+	for (v = 0; v < graph->iNumVertices; v++)
+	{
+		if (pReduced->iHeadM[v] == v)
+			continue;
+		pTo = &graph->vertexM[v];
+		pTo->iMaxFromSource = graph->vertexM[pReduced->iHeadM[v]].iMaxFromSource 
+			+ pReduced->offsetM[v];
+		pTo->iMaxFromSink = graph->vertexM[pReduced->iTailM[v]].iMaxFromSink
+			+ pReduced->restM[v];
+		pTo->iTL = graph->vertexM[pReduced->iTailM[v]].iTL - pReduced->restM[v];
+	}
 }
-/******************** newGraph **************************************
-    Graph newGraph()
+/************************** topologicalOrder ***********************************
+int topologicalOrder(Graph graph, int iOrderM[])
 Purpose:
-    Allocates a GraphImp and initializes its data.  It returns a
-    Graph. 
+    Orders the vertices so each vertex comes after all of its predecessors.
 Parameters:
-    n/a
+    I  Graph graph          Pointer to a graphImp
+    O  int iOrderM[]        Vertices in topological order
 Notes:
-    - Uses malloc to allocate a GraphImp.  It also makes certain
-      that malloc didn't fail.
-    - Initializes iNumvetices to 0.
-    - Initializes the array of vertices to zero bytes.
-    - 
+    Counts each vertex's predecessors and repeatedly takes a vertex whose
+    predecessors have all been ordered.  iOrderM is also the queue of 
+    vertices that are ready.
 Returns:
-    Graph - the newly allocated graph.
-**************************************************************************/
-Graph newGraph()
+    Number of vertices ordered.  If it is less than iNumVertices, the 
+    graph has a cycle.
+**********************************************************************************/
+int topologicalOrder(Graph graph, int iOrderM[])
 {
-    Graph g = (Graph)malloc(sizeof(GraphImp));
-    if (g == NULL)
-        ErrExit(ERR_ALGORITHM, "malloc for Graph failed");
-    g->iNumVertices = 0;
-    memset(g->vertexM, '\0',  sizeof(Vertex)*MAX_VERTICES);
-    return g;
+	int iCountM[MAX_VERTICES];      // predecessors not yet ordered
+	int iNumOrdered = 0;
+	int iNext;                      // next vertex in iOrderM to process
+	int v;
+	EdgeNode *e;
+	for (v = 0; v < graph->iNumVertices; v++)
+	{
+		iCountM[v] = 0;
+		for (e = graph->vertexM[v].predecessorList; e != NULL; e = e->pNextEdge)
+			iCountM[v]++;
+		if (iCountM[v] == 0)
+			iOrderM[iNumOrdered++] = v;
+	}
+	for (iNext = 0; iNext < iNumOrdered; iNext++)
+	{
+		v = iOrderM[iNext];
+		for (e = graph->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			if (--iCountM[e->edge.iVertex] == 0)
+				iOrderM[iNumOrdered++] = e->edge.iVertex;
+		}
+	}
+	return iNumOrdered;
 }
-/******************** buildGraph **************************************
-    Graph buildGraph(struct Data dataM[])
+/************************** removeRedundantEdges ***********************************
+int removeRedundantEdges(Graph graph, int *piNumRemoved)
 Purpose:
-    Builds a graph from an array of edges.  The Graph is represented by
-    an array of vertices and a double adjacency list.
+    Removes each edge u->v for which there is another path from u to v that
+    is longer than the edge.
 Parameters:
-    I   struct Data dataM[]     An array of edges (to, from, path weight)
-
+    I/O Graph graph         Pointer to a graphImp
+    O   int *piNumRemoved   Number of edges removed
 Notes:
-    - The array of edges is terminated by an edge having a from vertex
-      equal to the character '0'.
-    - Normally, this routine checks to make certain that the input did not
-      include a cycle, but since that code wasn't included, the check
-      has been commented out.
+    Such an edge can never be on a longest path, so removing it doesn't 
+    change any TE, TL or critical path.  An edge whose alternate path is
+    only as long is kept since it is on a critical path whenever the 
+    alternate path is.
+    The vertices are processed in chunks of 64.  For a chunk, a pass in 
+    topological order gives each vertex a bit mask of the chunk's vertices
+    that reach it.  An edge u->v only has an alternate path if some other 
+    predecessor of v is reached from u, and only then are the longest paths
+    from u computed (one pass in topological order starting at u).
+    The edges to remove are found before any are removed.  Since a removed
+    edge is always beaten by its alternate path, removing it doesn't change
+    the length of any longest path used to decide the others.
+    The removed EdgeNodes are unlinked from both lists but stay in 
+    edgeNodeM.
 Returns:
-    Graph - the newly allocated and populated graph.
-**************************************************************************/
-Graph buildGraph(struct Data dataM[])
+    PERT_OK - the edges were removed.
+    ERR_BAD_INPUT - the graph has a cycle.
+**********************************************************************************/
+int removeRedundantEdges(Graph graph, int *piNumRemoved)
 {
-    int i;
-    int iFrom;
-    int iTo;
-    Edge edge;
-    Graph graph = newGraph();
-    // Initialize the vertex array to zero bytes.
-    memset(graph->vertexM, '\0', sizeof(Vertex)*MAX_VERTICES);
+	int iOrderM[MAX_VERTICES];      // vertices in topological order
+	int iPositionM[MAX_VERTICES];   // subscript of each vertex in iOrderM
+	uint64_t reachM[MAX_VERTICES];  // vertices in the chunk reaching each vertex
+	Weight longestM[MAX_VERTICES];  // longest path from u (WEIGHT_MIN if none)
+	int iFromM[MAX_EDGES];          // edges to remove
+	int iToM[MAX_EDGES];
+	int iNumRemove = 0;
+	int iChunk;                     // first vertex in the chunk
+	int n = graph->iNumVertices;
+	int bAlternate;                 // TRUE if some edge from u has another path
+	int i;
+	int u;
+	int v;
+	uint64_t uBit;
+	Weight alternate;               // longest alternate path from u to v
+	EdgeNode *e;
+	EdgeNode *p;
 
-    // Go through the array of edges until a From of '\0' is encountered
-    for (i = 0; i < MAX_VERTICES; i++)
-    {
-        if (dataM[i].cFrom == '\0')
-            break;
-        // Find the From vertex.  searchVertices returns -1 for not found
-        iFrom = searchVertices(graph, dataM[i].cFrom);
-        if (iFrom == -1)
-        {   // not found, so insert the From vertex in the array
-            iFrom = graph->iNumVertices;
-            graph->iNumVertices++;
-            graph->vertexM[iFrom].cLabel = dataM[i].cFrom;
-        }
-        // Find the To vertex.  searchVertices returns -1 for not found
-        iTo = searchVertices(graph, dataM[i].cTo);
-        if (iTo == -1)
-        {   // not found, so insert the To vertex in the array
-            iTo = graph->iNumVertices;
-            graph->iNumVertices++;
-            graph->vertexM[iTo].cLabel = dataM[i].cTo;
-        }
-        // insert the edge on both the successor and predecessor lists
-        edge.iPath = dataM[i].iPath;
-        edge.iVertex = iTo;
-        insertOrderedLL(&graph->vertexM[iFrom].successorList, edge);
-        edge.iVertex = iFrom;
-        insertOrderedLL(&graph->vertexM[iTo].predecessorList, edge);
-    }
-//    if (!checkCycle(graph))
-//        ErrExit(ERR_BAD_INPUT, "Cycle in Graph");
-    return graph;
+	*piNumRemoved = 0;
+	if (topologicalOrder(graph, iOrderM) < n)
+		return ERR_BAD_INPUT;
+	for (i = 0; i < n; i++)
+		iPositionM[iOrderM[i]] = i;
+
+	for (iChunk = 0; iChunk < n; iChunk += 64)
+	{
+		for (i = 0; i < n; i++)
+		{
+			v = iOrderM[i];
+			reachM[v] = 0;
+			for (p = graph->vertexM[v].predecessorList; p != NULL; p = p->pNextEdge)
+			{
+				reachM[v] |= reachM[p->edge.iVertex];
+				if (p->edge.iVertex >= iChunk && p->edge.iVertex < iChunk + 64)
+					reachM[v] |= (uint64_t)1 << (p->edge.iVertex - iChunk);
+			}
+		}
+		for (u = iChunk; u < n && u < iChunk + 64; u++)
+		{
+			uBit = (uint64_t)1 << (u - iChunk);
+			bAlternate = FALSE;
+			for (e = graph->vertexM[u].successorList; e != NULL && !bAlternate; e = e->pNextEdge)
+			{
+				for (p = graph->vertexM[e->edge.iVertex].predecessorList; p != NULL; p = p->pNextEdge)
+				{
+					if (p->edge.iVertex != u && (reachM[p->edge.iVertex] & uBit))
+						bAlternate = TRUE;
+				}
+			}
+			if (!bAlternate)
+				continue;
+
+			// longest paths from u
+			for (i = iPositionM[u]; i < n; i++)
+				longestM[iOrderM[i]] = WEIGHT_MIN;
+			longestM[u] = 0;
+			for (i = iPositionM[u]; i < n; i++)
+			{
+				v = iOrderM[i];
+				if (longestM[v] == WEIGHT_MIN)
+					continue;
+				for (e = graph->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+				{
+					if (longestM[e->edge.iVertex] < longestM[v] + e->edge.iPath)
+						longestM[e->edge.iVertex] = longestM[v] + e->edge.iPath;
+				}
+			}
+
+			// compare each edge with the longest path through its TO vertex's
+			// other predecessors
+			for (e = graph->vertexM[u].successorList; e != NULL; e = e->pNextEdge)
+			{
+				alternate = WEIGHT_MIN;
+				for (p = graph->vertexM[e->edge.iVertex].predecessorList; p != NULL; p = p->pNextEdge)
+				{
+					if (p->edge.iVertex == u || iPositionM[p->edge.iVertex] < iPositionM[u]
+						|| longestM[p->edge.iVertex] == WEIGHT_MIN)
+						continue;
+					if (alternate < longestM[p->edge.iVertex] + p->edge.iPath)
+						alternate = longestM[p->edge.iVertex] + p->edge.iPath;
+				}
+				if (alternate != WEIGHT_MIN && alternate > e->edge.iPath 
+					&& !WEIGHT_EQUAL(alternate, e->edge.iPath))
+				{
+					iFromM[iNumRemove] = u;
+					iToM[iNumRemove] = e->edge.iVertex;
+					iNumRemove++;
+				}
+			}
+		}
+	}
+
+	for (i = 0; i < iNumRemove; i++)
+	{
+		e = searchLL(graph->vertexM[iFromM[i]].successorList, iToM[i], &p);
+		graph->ullEdgeHash -= hashEdge(graph->vertexM[iFromM[i]].cLabel
+			, graph->vertexM[iToM[i]].cLabel, e->edge.iPath);
+		unlinkEdge(&graph->vertexM[iFromM[i]].successorList, iToM[i]);
+		unlinkEdge(&graph->vertexM[iToM[i]].predecessorList, iFromM[i]);
+	}
+	graph->iNumEdges -= iNumRemove;
+	*piNumRemoved = iNumRemove;
+	return PERT_OK;
 }
-/******************** searchVertices **************************************
-   int searchVertices(Graph graph, char cVertex)
+/************************** unlinkEdge ***********************************
+void unlinkEdge(EdgeNode **ppHead, int iVertex)
 Purpose:
-    Searches the graph's array of vertices for the specified vertex.  If 
-    found, it returns the subscript.  If not found, it returns -1.
+    Unlinks the edge to or from a vertex from a successor or predecessor list.
 Parameters:
-    I   Graph graph             A directed graph represented by a double
-                                adjacency list an an array of vertices.
-    I   char cVertex            The vertex's label to be found.
+    I/O EdgeNode **ppHead   The list
+    I   int iVertex         The edge's iVertex
 Notes:
-    - this just uses a linear search.  It can be greatly improved using
-      a binary search (if sorted) or hashing
+    The EdgeNode isn't freed since it belongs to the graph's edgeNodeM.
 Returns:
-    >= 0 - subscript in the array of vertices if the vertex label is found 
-    -1 - not found
-**************************************************************************/
-int searchVertices(Graph graph, char cVertex)
+    N/A
+**********************************************************************************/
+void unlinkEdge(EdgeNode **ppHead, int iVertex)
 {
-    int i;
-    for (i = 0; i < graph->iNumVertices; i++)
-    {
-        if (cVertex == graph->vertexM[i].cLabel)
-            return i;
-    }
-    return -1;
+	EdgeNode **ppEdge;
+	for (ppEdge = ppHead; *ppEdge != NULL; ppEdge = &(*ppEdge)->pNextEdge)
+	{
+		if ((*ppEdge)->edge.iVertex == iVertex)
+		{
+			*ppEdge = (*ppEdge)->pNextEdge;
+			return;
+		}
+	}
 }
-/******************** printGraph **************************************
+/************************** computePertSmall ***********************************
+int computePertSmall(Graph graph)
+Purpose:
+    Computes the TE and TL of each vertex in a graph having at most 
+    SMALL_GRAPH_VERTICES vertices.
+Parameters:
+    I/O Graph graph         Pointer to a graphImp
+Notes:
+    Each vertex's predecessors are kept as a bit mask.  A topological order
+    is found by repeatedly taking the lowest vertex in the mask of vertices
+    whose predecessors have all been ordered and clearing its bit from its
+    successors' masks.  TE is then one pass over the successor lists in 
+    that order and the distance from the sinks is one pass in reverse order,
+    so each edge is visited twice instead of once per path through it.
+    The distances are kept in arrays on the stack and nothing is allocated.
+Returns:
+    PERT_OK - TE and TL were computed.
+    ERR_ALGORITHM - the graph doesn't have a source or a sink.
+    ERR_BAD_INPUT - the graph has a cycle.
+**********************************************************************************/
+int computePertSmall(Graph graph)
+{
+	uint64_t predMaskM[SMALL_GRAPH_VERTICES]; // predecessors not yet ordered
+	uint64_t readyMask = 0;                   // vertices ready to be ordered
+	uint64_t sinkMask = 0;                    // vertices without successors
+	int iOrderM[SMALL_GRAPH_VERTICES];        // vertices in topological order
+	Weight teM[SMALL_GRAPH_VERTICES];         // iMaxFromSource
+	Weight sinkM[SMALL_GRAPH_VERTICES];       // iMaxFromSink
+	Weight maxTE = WEIGHT_MIN;
+	int iNumOrdered = 0;
+	int i;
+	int v;
+	EdgeNode *e;
+	int n = graph->iNumVertices;
+
+	for (v = 0; v < n; v++)
+	{
+		predMaskM[v] = 0;
+		for (e = graph->vertexM[v].predecessorList; e != NULL; e = e->pNextEdge)
+			predMaskM[v] |= (uint64_t)1 << e->edge.iVertex;
+		if (predMaskM[v] == 0)
+			readyMask |= (uint64_t)1 << v;
+		if (graph->vertexM[v].successorList == NULL)
+			sinkMask |= (uint64_t)1 << v;
+		teM[v] = 0;
+		sinkM[v] = 0;
+	}
+	if (readyMask == 0 || sinkMask == 0)
+		return ERR_ALGORITHM;
+
+	// order the vertices
+	while (readyMask != 0)
+	{
+		v = lowestBit(readyMask);
+		readyMask &= readyMask - 1;
+		iOrderM[iNumOrdered++] = v;
+		for (e = graph->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			predMaskM[e->edge.iVertex] &= ~((uint64_t)1 << v);
+			if (predMaskM[e->edge.iVertex] == 0)
+				readyMask |= (uint64_t)1 << e->edge.iVertex;
+		}
+	}
+	if (iNumOrdered < n)
+		return ERR_BAD_INPUT;
+
+	// TE in topological order
+	for (i = 0; i < n; i++)
+	{
+		v = iOrderM[i];
+		if (teM[v] > maxTE)
+			maxTE = teM[v];
+		for (e = graph->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			if (teM[e->edge.iVertex] < teM[v] + e->edge.iPath)
+				teM[e->edge.iVertex] = teM[v] + e->edge.iPath;
+		}
+	}
+	// distance from the sinks in reverse order
+	for (i = n - 1; i >= 0; i--)
+	{
+		v = iOrderM[i];
+		for (e = graph->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			if (sinkM[v] < sinkM[e->edge.iVertex] + e->edge.iPath)
+				sinkM[v] = sinkM[e->edge.iVertex] + e->edge.iPath;
+		}
+	}
+	for (v = 0; v < n; v++)
+	{
+		graph->vertexM[v].iMaxFromSource = teM[v];
+		graph->vertexM[v].iMaxFromSink = sinkM[v];
+		graph->vertexM[v].iTL = maxTE - sinkM[v];
+	}
+	return PERT_OK;
+}
+/************************** lowestBit ***********************************
+int lowestBit(uint64_t mask)
+Purpose:
+    Returns the subscript of the lowest bit that is set in a mask.
+Parameters:
+    I  uint64_t mask        Mask with at least one bit set
+Returns:
+    0 - 63
+**********************************************************************************/
+int lowestBit(uint64_t mask)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzll(mask);
+#else
+	int i = 0;
+	while ((mask & 1) == 0)
+	{
+		mask >>= 1;
+		i++;
+	}
+	return i;
+#endif
+}
+/************************** newPertContext ***********************************
+PertContext newPertContext()
+Purpose:
+    Allocates a PERT context for use by a program embedding the PERT 
+    functions.
+Parameters:
+    n/a
+Notes:
+    A context owns its graph (including the EdgeNodes) so building, computing
+    and resetting it don't allocate anything.  A context is only used by the
+    thread that calls these functions with it, so separate contexts can be
+    used by separate threads at the same time.
+Returns:
+    PertContext - the new context or NULL if malloc failed.
+**********************************************************************************/
+PertContext newPertContext()
+{
+	PertContext ctx = (PertContext)malloc(sizeof(PertContextImp));
+	if (ctx == NULL)
+		return NULL;
+	ctx->graph.iNumVertices = 0;
+	ctx->graph.iNumEdges = 0;
+	memset(ctx->graph.vertexM, '\0', sizeof(Vertex)*MAX_VERTICES);
+	ctx->bComputed = FALSE;
+	memset(ctx->iLabelM, -1, sizeof(ctx->iLabelM));
+	ctx->szErrMsg[0] = '\0';
+	return ctx;
+}
+/************************** freePertContext ***********************************
+void freePertContext(PertContext ctx)
+Purpose:
+    Frees a PERT context and everything it owns.
+Parameters:
+    I  PertContext ctx      Context from newPertContext
+Returns:
+    N/A
+**********************************************************************************/
+void freePertContext(PertContext ctx)
+{
+	free(ctx);
+}
+/************************** pertBuild ***********************************
+int pertBuild(PertContext ctx, struct Data dataM[])
+Purpose:
+    Replaces the context's graph with one built from an array of edges.
+Parameters:
+    I/O PertContext ctx     Context from newPertContext
+    I   struct Data dataM[] An array of edges terminated by a cFrom of '\0'
+                            (at most MAX_EDGES edges)
+Notes:
+    On an error, the context is left empty and pertErrorMessage describes
+    the error.  Otherwise the labels are indexed for pertQueryVertex.
+Returns:
+    PERT_OK - the graph was built.
+    ERR_BAD_INPUT - the edges have too many vertices.
+**********************************************************************************/
+int pertBuild(PertContext ctx, struct Data dataM[])
+{
+	int rc;
+	int i;
+	pertReset(ctx);
+	ctx->szErrMsg[0] = '\0';
+	rc = loadGraph(&ctx->graph, dataM);
+	if (rc != PERT_OK)
+	{
+		strcpy(ctx->szErrMsg, "too many vertices");
+		pertReset(ctx);
+		return rc;
+	}
+	for (i = 0; i < ctx->graph.iNumVertices; i++)
+		ctx->iLabelM[(unsigned char)ctx->graph.vertexM[i].cLabel] = i;
+	return PERT_OK;
+}
+/************************** pertCompute ***********************************
+int pertCompute(PertContext ctx)
+Purpose:
+    Computes TE and TL for the context's graph.
+Parameters:
+    I/O PertContext ctx     Context from newPertContext
+Returns:
+    PERT_OK - TE and TL were computed.
+    ERR_ALGORITHM - the graph doesn't have a source or a sink (see 
+                    pertErrorMessage).
+    ERR_BAD_INPUT - the graph has a cycle.
+**********************************************************************************/
+int pertCompute(PertContext ctx)
+{
+	int rc;
+	rc = computePertTEAndTL(&ctx->graph);
+	if (rc != PERT_OK)
+	{
+		if (rc == ERR_BAD_INPUT)
+			strcpy(ctx->szErrMsg, "Cycle in Graph");
+		else
+			strcpy(ctx->szErrMsg, "graph doesn't have a source or a sink");
+		return rc;
+	}
+	ctx->bComputed = TRUE;
+	return PERT_OK;
+}
+/************************** pertGraph ***********************************
+Graph pertGraph(PertContext ctx)
+Purpose:
+    Returns the context's graph so it can be examined or printed.
+Parameters:
+    I  PertContext ctx      Context from newPertContext
+Notes:
+    The graph belongs to the context.  It must not be passed to freeGraph
+    and it is only valid until the next pertBuild or pertReset.
+Returns:
+    Graph - the context's graph.
+**********************************************************************************/
+Graph pertGraph(PertContext ctx)
+{
+	return &ctx->graph;
+}
+/************************** pertReset ***********************************
+void pertReset(PertContext ctx)
+Purpose:
+    Empties the context's graph so the context can be reused.
+Parameters:
+    I/O PertContext ctx     Context from newPertContext
+Notes:
+    Only the vertices that were used are cleared.
+Returns:
+    N/A
+**********************************************************************************/
+void pertReset(PertContext ctx)
+{
+	int i;
+	for (i = 0; i < ctx->graph.iNumVertices; i++)
+		ctx->iLabelM[(unsigned char)ctx->graph.vertexM[i].cLabel] = -1;
+	memset(ctx->graph.vertexM, '\0', sizeof(Vertex)*ctx->graph.iNumVertices);
+	ctx->graph.iNumVertices = 0;
+	ctx->graph.iNumEdges = 0;
+	ctx->bComputed = FALSE;
+}
+/************************** pertErrorMessage ***********************************
+char *pertErrorMessage(PertContext ctx)
+Purpose:
+    Describes the last error returned by a function using the context.
+Parameters:
+    I  PertContext ctx      Context from newPertContext
+Returns:
+    char * - the message ("" if there wasn't an error).
+**********************************************************************************/
+char *pertErrorMessage(PertContext ctx)
+{
+	return ctx->szErrMsg;
+}
+/************************** getVertexResult ***********************************
+void getVertexResult(Graph g, int v, VertexResult *pResult)
+Purpose:
+    Copies a vertex's PERT results.
+Parameters:
+    I  Graph g              Pointer to a graphImp with TE and TL computed
+    I  int v                Index for vertexM[]
+    O  VertexResult *pResult  The vertex's label, TE, TL, slack and whether
+                            it is critical.
+Returns:
+    N/A
+**********************************************************************************/
+void getVertexResult(Graph g, int v, VertexResult *pResult)
+{
+	pResult->cLabel = g->vertexM[v].cLabel;
+	pResult->iTE = g->vertexM[v].iMaxFromSource;
+	pResult->iTL = g->vertexM[v].iTL;
+	pResult->iSlack = g->vertexM[v].iTL - g->vertexM[v].iMaxFromSource;
+	pResult->bCritical = WEIGHT_EQUAL(pResult->iTE, pResult->iTL);
+}
+/************************** isCriticalEdge ***********************************
+int isCriticalEdge(Graph g, int iFrom, Edge edge)
+Purpose:
+    Determines whether an edge is on a critical path.
+Parameters:
+    I  Graph g              Pointer to a graphImp with TE and TL computed
+    I  int iFrom            Index for vertexM[] of the FROM vertex
+    I  Edge edge            A successor edge of iFrom
+Notes:
+    Both ends being critical isn't enough:  the edge also has to have no
+    slack (TE of FROM + path weight = TL of TO).
+Returns:
+    TRUE - the edge is critical
+    FALSE - it isn't
+**********************************************************************************/
+int isCriticalEdge(Graph g, int iFrom, Edge edge)
+{
+	Vertex *pFrom = &g->vertexM[iFrom];
+	Vertex *pTo = &g->vertexM[edge.iVertex];
+	return WEIGHT_EQUAL(pFrom->iMaxFromSource, pFrom->iTL)
+		&& WEIGHT_EQUAL(pTo->iMaxFromSource, pTo->iTL)
+		&& WEIGHT_EQUAL(pFrom->iMaxFromSource + edge.iPath, pTo->iTL);
+}
+/************************** pertQueryVertex ***********************************
+int pertQueryVertex(PertContext ctx, char cLabel, VertexResult *pResult)
+Purpose:
+    Returns the TE, TL, slack and critical flag of a vertex.
+Parameters:
+    I  PertContext ctx      Context from newPertContext
+    I  char cLabel          The vertex's label
+    O  VertexResult *pResult  The vertex's results
+Returns:
+    PERT_OK - *pResult was set.
+    ERR_BAD_INPUT - the graph doesn't have the vertex.
+    ERR_ALGORITHM - pertCompute hasn't been done for this graph.
+**********************************************************************************/
+int pertQueryVertex(PertContext ctx, char cLabel, VertexResult *pResult)
+{
+	int v;
+	if (!ctx->bComputed)
+	{
+		strcpy(ctx->szErrMsg, "TE and TL haven't been computed");
+		return ERR_ALGORITHM;
+	}
+	v = ctx->iLabelM[(unsigned char)cLabel];
+	if (v < 0)
+	{
+		sprintf(ctx->szErrMsg, "vertex '%c' not found", cLabel);
+		return ERR_BAD_INPUT;
+	}
+	getVertexResult(&ctx->graph, v, pResult);
+	return PERT_OK;
+}
+/************************** pertExportVertices ***********************************
+int pertExportVertices(PertContext ctx, VertexResult resultM[], int *piNumVertices)
+Purpose:
+    Returns the TE, TL, slack and critical flag of every vertex.
+Parameters:
+    I  PertContext ctx      Context from newPertContext
+    O  VertexResult resultM[]  One entry per vertex in vertexM[] order 
+                            (room for MAX_VERTICES entries).
+    O  int *piNumVertices   Number of entries in resultM.
+Returns:
+    PERT_OK - the results were returned.
+    ERR_ALGORITHM - pertCompute hasn't been done for this graph.
+**********************************************************************************/
+int pertExportVertices(PertContext ctx, VertexResult resultM[], int *piNumVertices)
+{
+	int v;
+	*piNumVertices = 0;
+	if (!ctx->bComputed)
+	{
+		strcpy(ctx->szErrMsg, "TE and TL haven't been computed");
+		return ERR_ALGORITHM;
+	}
+	for (v = 0; v < ctx->graph.iNumVertices; v++)
+		getVertexResult(&ctx->graph, v, &resultM[v]);
+	*piNumVertices = ctx->graph.iNumVertices;
+	return PERT_OK;
+}
+/************************** pertExportCriticalEdges ***********************************
+int pertExportCriticalEdges(PertContext ctx, struct Data edgeM[], int *piNumEdges)
+Purpose:
+    Returns the edges that are on a critical path.
+Parameters:
+    I  PertContext ctx      Context from newPertContext
+    O  struct Data edgeM[]  The critical edges (from, to, path weight) in 
+                            successor list order, terminated by a cFrom of
+                            '\0' like dataM (room for MAX_EDGES + 1 entries).
+    O  int *piNumEdges      Number of critical edges.
+Returns:
+    PERT_OK - the edges were returned.
+    ERR_ALGORITHM - pertCompute hasn't been done for this graph.
+**********************************************************************************/
+int pertExportCriticalEdges(PertContext ctx, struct Data edgeM[], int *piNumEdges)
+{
+	int v;
+	int iNumEdges = 0;
+	EdgeNode *e;
+	Graph g = &ctx->graph;
+	*piNumEdges = 0;
+	edgeM[0].cFrom = '\0';
+	if (!ctx->bComputed)
+	{
+		strcpy(ctx->szErrMsg, "TE and TL haven't been computed");
+		return ERR_ALGORITHM;
+	}
+	for (v = 0; v < g->iNumVertices; v++)
+	{
+		for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			if (!isCriticalEdge(g, v, e->edge))
+				continue;
+			edgeM[iNumEdges].cFrom = g->vertexM[v].cLabel;
+			edgeM[iNumEdges].cTo = g->vertexM[e->edge.iVertex].cLabel;
+			edgeM[iNumEdges].iPath = e->edge.iPath;
+			iNumEdges++;
+		}
+	}
+	edgeM[iNumEdges].cFrom = '\0';
+	*piNumEdges = iNumEdges;
+	return PERT_OK;
+}
+/************************** pertRemoveRedundantEdges ***********************************
+int pertRemoveRedundantEdges(PertContext ctx, int *piNumRemoved)
+Purpose:
+    Removes the edges of the context's graph that can't decide a longest 
+    path (see removeRedundantEdges).
+Parameters:
+    I/O PertContext ctx     Context from newPertContext
+    O   int *piNumRemoved   Number of edges removed
+Notes:
+    TE and TL have to be computed again afterwards.
+Returns:
+    PERT_OK - the edges were removed.
+    ERR_BAD_INPUT - the graph has a cycle.
+**********************************************************************************/
+int pertRemoveRedundantEdges(PertContext ctx, int *piNumRemoved)
+{
+	int rc;
+	ctx->bComputed = FALSE;
+	rc = removeRedundantEdges(&ctx->graph, piNumRemoved);
+	if (rc != PERT_OK)
+		strcpy(ctx->szErrMsg, "Cycle in Graph");
+	return rc;
+}
+/************************** pertUpdatePath ***********************************
+int pertUpdatePath(PertContext ctx, char cFrom, char cTo, Weight iPath)
+Purpose:
+    Changes the path weight of an edge of the context's graph without 
+    rebuilding the graph.
+Parameters:
+    I/O PertContext ctx     Context from newPertContext
+    I   char cFrom          Label of the edge's FROM vertex
+    I   char cTo            Label of the edge's TO vertex
+    I   Weight iPath        The new path weight
+Notes:
+    The edge is changed in both the successor and predecessor lists.  TE 
+    and TL have to be computed again afterwards.
+Returns:
+    PERT_OK - the weight was changed.
+    ERR_BAD_INPUT - the graph doesn't have the edge.
+**********************************************************************************/
+int pertUpdatePath(PertContext ctx, char cFrom, char cTo, Weight iPath)
+{
+	int iFrom = ctx->iLabelM[(unsigned char)cFrom];
+	int iTo = ctx->iLabelM[(unsigned char)cTo];
+	EdgeNode *e;
+	EdgeNode *p;
+	if (iFrom < 0 || iTo < 0)
+		e = NULL;
+	else
+		e = searchLL(ctx->graph.vertexM[iFrom].successorList, iTo, &p);
+	if (e == NULL)
+	{
+		sprintf(ctx->szErrMsg, "edge %c %c not found", cFrom, cTo);
+		return ERR_BAD_INPUT;
+	}
+	ctx->graph.ullEdgeHash += hashEdge(cFrom, cTo, iPath) - hashEdge(cFrom, cTo, e->edge.iPath);
+	e->edge.iPath = iPath;
+	e = searchLL(ctx->graph.vertexM[iTo].predecessorList, iFrom, &p);
+	e->edge.iPath = iPath;
+	ctx->bComputed = FALSE;
+	return PERT_OK;
+}
+/************************** pertEvaluateScenarios ***********************************
+int pertEvaluateScenarios(PertContext ctx, Override overrideM[], int iNumOverrides
+    , int iNumScenarios, ScenarioResult resultM[])
+Purpose:
+    Evaluates what-if scenarios, each of which changes the weights of some
+    edges of the context's graph, without changing or rebuilding the graph.
+Parameters:
+    I/O PertContext ctx     Context from newPertContext (pertCompute done)
+    I   Override overrideM[]  The changed edge weights for all scenarios
+    I   int iNumOverrides   Number of entries in overrideM
+    I   int iNumScenarios   Number of scenarios
+    O   ScenarioResult resultM[]  Makespan and critical vertex changes for 
+                            each scenario (counts and vertex masks)
+Notes:
+    The topological order and a CSR copy of the successor lists (each 
+    vertex's edges are iSuccStartM[v] .. iSuccStartM[v + 1] - 1) are made 
+    once.  Then SCENARIO_BLOCK scenarios at a time are evaluated together
+    by evaluateScenarioBlock.
+Returns:
+    PERT_OK - the scenarios were evaluated.
+    ERR_BAD_INPUT - an override's edge isn't in the graph, its scenario is
+                    out of range or the graph has a cycle.
+    ERR_ALGORITHM - pertCompute hasn't been done for this graph.
+**********************************************************************************/
+int pertEvaluateScenarios(PertContext ctx, Override overrideM[], int iNumOverrides
+    , int iNumScenarios, ScenarioResult resultM[])
+{
+	int iOrderM[MAX_VERTICES];          // vertices in topological order
+	int iSuccStartM[MAX_VERTICES + 1];  // first CSR edge of each vertex
+	int iSuccToM[MAX_EDGES];            // TO vertex of each CSR edge
+	int iBlock;                         // first scenario in the block
+	int iNumInBlock;
+	int i;
+	int k;
+	int s;
+	int v;
+	EdgeNode *e;
+	Graph g = &ctx->graph;
+
+	if (!ctx->bComputed)
+	{
+		strcpy(ctx->szErrMsg, "TE and TL haven't been computed");
+		return ERR_ALGORITHM;
+	}
+	if (topologicalOrder(g, iOrderM) < g->iNumVertices)
+	{
+		strcpy(ctx->szErrMsg, "Cycle in Graph");
+		return ERR_BAD_INPUT;
+	}
+	// CSR successors
+	k = 0;
+	for (v = 0; v < g->iNumVertices; v++)
+	{
+		iSuccStartM[v] = k;
+		for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+			iSuccToM[k++] = e->edge.iVertex;
+	}
+	iSuccStartM[g->iNumVertices] = k;
+
+	// check each override's edge and scenario
+	for (i = 0; i < iNumOverrides; i++)
+	{
+		if (findScenarioEdge(ctx, iSuccStartM, iSuccToM, &overrideM[i]) < 0
+			|| overrideM[i].iScenario < 0 || overrideM[i].iScenario >= iNumScenarios)
+		{
+			sprintf(ctx->szErrMsg, "override %d: edge %c %c not found for scenario %d"
+				, i, overrideM[i].cFrom, overrideM[i].cTo, overrideM[i].iScenario);
+			return ERR_BAD_INPUT;
+		}
+	}
+
+	for (iBlock = 0; iBlock < iNumScenarios; iBlock += SCENARIO_BLOCK)
+	{
+		iNumInBlock = iNumScenarios - iBlock;
+		if (iNumInBlock > SCENARIO_BLOCK)
+			iNumInBlock = SCENARIO_BLOCK;
+		// start each scenario with the graph's weights and apply its overrides
+		for (v = 0; v < g->iNumVertices; v++)
+		{
+			k = iSuccStartM[v];
+			for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge, k++)
+			{
+				for (s = 0; s < SCENARIO_BLOCK; s++)
+					ctx->scenarioPathM[k * SCENARIO_BLOCK + s] = e->edge.iPath;
+			}
+		}
+		for (i = 0; i < iNumOverrides; i++)
+		{
+			s = overrideM[i].iScenario - iBlock;
+			if (s >= 0 && s < iNumInBlock)
+			{
+				k = findScenarioEdge(ctx, iSuccStartM, iSuccToM, &overrideM[i]);
+				ctx->scenarioPathM[k * SCENARIO_BLOCK + s] = overrideM[i].iPath;
+			}
+		}
+		evaluateScenarioBlock(ctx, iOrderM, iSuccStartM, iSuccToM, iNumInBlock, &resultM[iBlock]);
+	}
+	return PERT_OK;
+}
+/************************** findScenarioEdge ***********************************
+int findScenarioEdge(PertContext ctx, int iSuccStartM[], int iSuccToM[], Override *pOverride)
+Purpose:
+    Finds the CSR edge changed by an override.
+Parameters:
+    I  PertContext ctx      Context from newPertContext
+    I  int iSuccStartM[]    First CSR edge of each vertex
+    I  int iSuccToM[]       TO vertex of each CSR edge
+    I  Override *pOverride  The override
+Returns:
+    >= 0 - subscript of the edge in iSuccToM
+    -1 - the graph doesn't have the edge
+**********************************************************************************/
+int findScenarioEdge(PertContext ctx, int iSuccStartM[], int iSuccToM[], Override *pOverride)
+{
+	int iFrom = ctx->iLabelM[(unsigned char)pOverride->cFrom];
+	int iTo = ctx->iLabelM[(unsigned char)pOverride->cTo];
+	int k;
+	if (iFrom < 0 || iTo < 0)
+		return -1;
+	for (k = iSuccStartM[iFrom]; k < iSuccStartM[iFrom + 1]; k++)
+	{
+		if (iSuccToM[k] == iTo)
+			return k;
+	}
+	return -1;
+}
+/************************** evaluateScenarioBlock ***********************************
+void evaluateScenarioBlock(PertContext ctx, int iOrderM[], int iSuccStartM[], int iSuccToM[]
+    , int iNumScenarios, ScenarioResult resultM[])
+Purpose:
+    Computes the makespan and critical vertex changes of up to 
+    SCENARIO_BLOCK scenarios at once.
+Parameters:
+    I/O PertContext ctx     Context whose scenarioPathM has each scenario's
+                            weights
+    I   int iOrderM[]       Vertices in topological order
+    I   int iSuccStartM[]   First CSR edge of each vertex
+    I   int iSuccToM[]      TO vertex of each CSR edge
+    I   int iNumScenarios   Number of scenarios in the block
+    O   ScenarioResult resultM[]  Results for the block's scenarios
+Notes:
+    The passes are the same as computePertSmall's but each vertex and edge
+    has a row of SCENARIO_BLOCK values, so the innermost loops run over the
+    scenarios with no dependencies between them and can be vectorized.
+    A vertex is critical in a scenario if its TE plus its distance from 
+    the sinks is the scenario's makespan.
+Returns:
+    N/A
+**********************************************************************************/
+void evaluateScenarioBlock(PertContext ctx, int iOrderM[], int iSuccStartM[], int iSuccToM[]
+    , int iNumScenarios, ScenarioResult resultM[])
+{
+	Graph g = &ctx->graph;
+	Weight *teM = ctx->scenarioTeM;
+	Weight *sinkM = ctx->scenarioSinkM;
+	Weight *pathM = ctx->scenarioPathM;
+	Weight *pFrom;
+	Weight *pTo;
+	Weight *pPath;
+	int n = g->iNumVertices;
+	int bCritical;
+	int bWasCritical;
+	int i;
+	int k;
+	int s;
+	int v;
+
+	for (i = 0; i < n * SCENARIO_BLOCK; i++)
+	{
+		teM[i] = 0;
+		sinkM[i] = 0;
+	}
+	// TE in topological order
+	for (i = 0; i < n; i++)
+	{
+		v = iOrderM[i];
+		pFrom = &teM[v * SCENARIO_BLOCK];
+		for (k = iSuccStartM[v]; k < iSuccStartM[v + 1]; k++)
+		{
+			pTo = &teM[iSuccToM[k] * SCENARIO_BLOCK];
+			pPath = &pathM[k * SCENARIO_BLOCK];
+			for (s = 0; s < SCENARIO_BLOCK; s++)
+				pTo[s] = pTo[s] > pFrom[s] + pPath[s] ? pTo[s] : pFrom[s] + pPath[s];
+		}
+	}
+	// distance from the sinks in reverse order
+	for (i = n - 1; i >= 0; i--)
+	{
+		v = iOrderM[i];
+		pTo = &sinkM[v * SCENARIO_BLOCK];
+		for (k = iSuccStartM[v]; k < iSuccStartM[v + 1]; k++)
+		{
+			pFrom = &sinkM[iSuccToM[k] * SCENARIO_BLOCK];
+			pPath = &pathM[k * SCENARIO_BLOCK];
+			for (s = 0; s < SCENARIO_BLOCK; s++)
+				pTo[s] = pTo[s] > pFrom[s] + pPath[s] ? pTo[s] : pFrom[s] + pPath[s];
+		}
+	}
+	for (s = 0; s < iNumScenarios; s++)
+	{
+		resultM[s].maxTE = WEIGHT_MIN;
+		resultM[s].iNumNowCritical = 0;
+		resultM[s].iNumNoLongerCritical = 0;
+		memset(resultM[s].nowCriticalM, 0, sizeof(resultM[s].nowCriticalM));
+		memset(resultM[s].noLongerCriticalM, 0, sizeof(resultM[s].noLongerCriticalM));
+	}
+	for (v = 0; v < n; v++)
+	{
+		for (s = 0; s < iNumScenarios; s++)
+		{
+			if (teM[v * SCENARIO_BLOCK + s] > resultM[s].maxTE)
+				resultM[s].maxTE = teM[v * SCENARIO_BLOCK + s];
+		}
+	}
+	for (v = 0; v < n; v++)
+	{
+		bWasCritical = WEIGHT_EQUAL(g->vertexM[v].iMaxFromSource, g->vertexM[v].iTL);
+		for (s = 0; s < iNumScenarios; s++)
+		{
+			bCritical = WEIGHT_EQUAL(teM[v * SCENARIO_BLOCK + s] + sinkM[v * SCENARIO_BLOCK + s]
+				, resultM[s].maxTE);
+			if (bCritical && !bWasCritical)
+			{
+				resultM[s].iNumNowCritical++;
+				resultM[s].nowCriticalM[v / 64] |= (uint64_t)1 << (v % 64);
+			}
+			else if (!bCritical && bWasCritical)
+			{
+				resultM[s].iNumNoLongerCritical++;
+				resultM[s].noLongerCriticalM[v / 64] |= (uint64_t)1 << (v % 64);
+			}
+		}
+	}
+}
+/************************** pertCrash ***********************************
+int pertCrash(PertContext ctx, Crash crashM[], Weight deadline
+    , CrashStepFn pfnStep, void *pState)
+Purpose:
+    Shortens the context's project by crashing (shortening) edges at the
+    least cost, one unit of makespan at a time, and reports each point of
+    the resulting time-cost curve.
+Parameters:
+    I/O PertContext ctx     Context with a built graph.  Its path weights
+                            are left at the last step's durations.
+    I   Crash crashM[]      Crash duration and cost slope of the edges that
+                            can be shortened, terminated by a cFrom of '\0'.
+                            The other edges can't be shortened.
+    I   Weight deadline     Stops once the makespan is at most this (0 
+                            crashes as far as possible).
+    I   CrashStepFn pfnStep Called with the starting point and after each
+                            step.
+    I   void *pState        Passed to pfnStep.
+Notes:
+    Each step is a Phillips-Dessouky step:  crashCut finds a minimum cut 
+    of the critical edges, the edges crossing it forward are shortened 
+    and the edges crossing it backward that were shortened earlier are 
+    lengthened again (getting their slope back).  Every critical path 
+    crosses forward once more than backward, so each gets shorter.
+    The step is one unit, but no more than any changed edge can move and
+    no more than the smallest positive slack of an edge (so no other path
+    becomes longer than the new makespan).  TE and TL are then updated 
+    from the changed edges only (see crashUpdateTimes) instead of being 
+    computed again.  The input weights are the normal durations.
+Returns:
+    PERT_OK - the curve was computed.
+    ERR_BAD_INPUT - a crash names an edge not in the graph, or its crash
+                    duration or slope isn't valid.
+    ERR_ALGORITHM - TE and TL couldn't be computed or malloc failed.
+**********************************************************************************/
+int pertCrash(PertContext ctx, Crash crashM[], Weight deadline
+	, CrashStepFn pfnStep, void *pState)
+{
+	CrashNetwork *pNet;
+	int iCutFromM[MAX_EDGES];           // the edges changed by the step
+	int iCutToM[MAX_EDGES];
+	int iChangeM[MAX_EDGES];            // -1 to shorten, 1 to lengthen
+	struct Data changedM[MAX_EDGES];    // changed edges with their new weights
+	int iOrderM[MAX_VERTICES];          // vertices in topological order
+	Graph g = &ctx->graph;
+	Weight cost = 0;                    // total cost of the steps so far
+	Weight makespan;
+	Weight step;                        // how much the cut edges are changed
+	Weight room;                        // how much one edge can change
+	int iNumCut;
+	int rc;
+	int i;
+	int u;
+	int v;
+	EdgeNode *e;
+	EdgeNode *p;
+	Vertex *pFrom;
+	Vertex *pTo;
+
+	if (!ctx->bComputed)
+	{
+		rc = pertCompute(ctx);
+		if (rc != PERT_OK)
+			return rc;
+	}
+	pNet = (CrashNetwork *)malloc(sizeof(CrashNetwork));
+	if (pNet == NULL)
+	{
+		strcpy(ctx->szErrMsg, "malloc for CrashNetwork failed");
+		return ERR_ALGORITHM;
+	}
+	for (u = 0; u < g->iNumVertices; u++)
+	{
+		for (e = g->vertexM[u].successorList; e != NULL; e = e->pNextEdge)
+		{
+			pNet->normalM[u][e->edge.iVertex] = e->edge.iPath;
+			pNet->crashM[u][e->edge.iVertex] = e->edge.iPath;
+			pNet->slopeM[u][e->edge.iVertex] = 0;
+		}
+	}
+	for (i = 0; crashM[i].cFrom != '\0'; i++)
+	{
+		u = ctx->iLabelM[(unsigned char)crashM[i].cFrom];
+		v = ctx->iLabelM[(unsigned char)crashM[i].cTo];
+		e = u < 0 || v < 0 ? NULL : searchLL(g->vertexM[u].successorList, v, &p);
+		if (e == NULL || crashM[i].crash < 0 || crashM[i].crash > e->edge.iPath
+			|| crashM[i].slope < 0)
+		{
+			sprintf(ctx->szErrMsg, "invalid crash for edge %c %c"
+				, crashM[i].cFrom, crashM[i].cTo);
+			free(pNet);
+			return ERR_BAD_INPUT;
+		}
+		pNet->crashM[u][v] = crashM[i].crash;
+		pNet->slopeM[u][v] = crashM[i].slope;
+	}
+	// the steps only change weights, so the order doesn't change
+	topologicalOrder(g, iOrderM);
+
+	makespan = findMaxTE(g);
+	pfnStep(makespan, cost, changedM, 0, pState);
+	while (makespan > deadline)
+	{
+		iNumCut = crashCut(g, pNet, iCutFromM, iCutToM, iChangeM);
+		if (iNumCut < 0)
+			break;                      // every cut has an edge that can't be shortened
+		step = 1;
+		for (i = 0; i < iNumCut; i++)
+		{
+			e = searchLL(g->vertexM[iCutFromM[i]].successorList, iCutToM[i], &p);
+			if (iChangeM[i] < 0)
+				room = e->edge.iPath - pNet->crashM[iCutFromM[i]][iCutToM[i]];
+			else
+				room = pNet->normalM[iCutFromM[i]][iCutToM[i]] - e->edge.iPath;
+			if (room < step)
+				step = room;
+		}
+		for (u = 0; u < g->iNumVertices; u++)
+		{
+			pFrom = &g->vertexM[u];
+			for (e = pFrom->successorList; e != NULL; e = e->pNextEdge)
+			{
+				pTo = &g->vertexM[e->edge.iVertex];
+				room = pTo->iMaxFromSource - pFrom->iMaxFromSource - e->edge.iPath;
+				if (!WEIGHT_EQUAL(pFrom->iMaxFromSource + e->edge.iPath, pTo->iMaxFromSource)
+					&& room < step)
+					step = room;
+				room = pTo->iTL - pFrom->iTL - e->edge.iPath;
+				if (!WEIGHT_EQUAL(pFrom->iTL + e->edge.iPath, pTo->iTL) && room < step)
+					step = room;
+			}
+		}
+		for (i = 0; i < iNumCut; i++)
+		{
+			e = searchLL(g->vertexM[iCutFromM[i]].successorList, iCutToM[i], &p);
+			changedM[i].cFrom = g->vertexM[iCutFromM[i]].cLabel;
+			changedM[i].cTo = g->vertexM[iCutToM[i]].cLabel;
+			changedM[i].iPath = e->edge.iPath + iChangeM[i] * step;
+			cost -= iChangeM[i] * step * pNet->slopeM[iCutFromM[i]][iCutToM[i]];
+			pertUpdatePath(ctx, changedM[i].cFrom, changedM[i].cTo, changedM[i].iPath);
+		}
+		crashUpdateTimes(g, iOrderM, iCutFromM, iCutToM, iNumCut);
+		ctx->bComputed = TRUE;
+		if (!(findMaxTE(g) < makespan))
+			break;                      // can't happen unless the weights underflow
+		makespan = findMaxTE(g);
+		pfnStep(makespan, cost, changedM, iNumCut, pState);
+	}
+	free(pNet);
+	return PERT_OK;
+}
+/************************** crashUpdateTimes ***********************************
+void crashUpdateTimes(Graph g, int iOrderM[], int iFromM[], int iToM[], int iNumChanged)
+Purpose:
+    Updates TE and TL after pertCrash changes the weights of some edges.
+Parameters:
+    I/O Graph g             Pointer to a graphImp with TE and TL computed
+                            before the weights were changed
+    I   int iOrderM[]       Its vertices in topological order
+    I   int iFromM[]        FROM vertex of each changed edge
+    I   int iToM[]          TO vertex of each changed edge
+    I   int iNumChanged     Number of changed edges
+Notes:
+    Only the TO vertices of the changed edges can have a new TE, so TE is
+    recomputed from the predecessors in topological order starting with 
+    them, and a vertex whose TE changes marks its successors.  The distance
+    from the sinks is done the same way backwards from the FROM vertices.
+    TL is then the new maximum TE less the distance from the sinks.
+Returns:
+    N/A
+**********************************************************************************/
+void crashUpdateTimes(Graph g, int iOrderM[], int iFromM[], int iToM[], int iNumChanged)
+{
+	int bDirtyM[MAX_VERTICES];          // TRUE if the vertex has to be recomputed
+	int n = g->iNumVertices;
+	Weight value;
+	Weight maxTE;
+	int i;
+	int v;
+	EdgeNode *e;
+
+	// TE forward from the TO vertices
+	memset(bDirtyM, 0, sizeof(bDirtyM));
+	for (i = 0; i < iNumChanged; i++)
+		bDirtyM[iToM[i]] = TRUE;
+	for (i = 0; i < n; i++)
+	{
+		v = iOrderM[i];
+		if (!bDirtyM[v])
+			continue;
+		value = g->vertexM[v].predecessorList == NULL ? 0 : WEIGHT_MIN;
+		for (e = g->vertexM[v].predecessorList; e != NULL; e = e->pNextEdge)
+		{
+			if (g->vertexM[e->edge.iVertex].iMaxFromSource + e->edge.iPath > value)
+				value = g->vertexM[e->edge.iVertex].iMaxFromSource + e->edge.iPath;
+		}
+		if (value == g->vertexM[v].iMaxFromSource)
+			continue;
+		g->vertexM[v].iMaxFromSource = value;
+		for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+			bDirtyM[e->edge.iVertex] = TRUE;
+	}
+
+	// distance from the sinks backward from the FROM vertices
+	memset(bDirtyM, 0, sizeof(bDirtyM));
+	for (i = 0; i < iNumChanged; i++)
+		bDirtyM[iFromM[i]] = TRUE;
+	for (i = n - 1; i >= 0; i--)
+	{
+		v = iOrderM[i];
+		if (!bDirtyM[v])
+			continue;
+		value = g->vertexM[v].successorList == NULL ? 0 : WEIGHT_MIN;
+		for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+		{
+			if (g->vertexM[e->edge.iVertex].iMaxFromSink + e->edge.iPath > value)
+				value = g->vertexM[e->edge.iVertex].iMaxFromSink + e->edge.iPath;
+		}
+		if (value == g->vertexM[v].iMaxFromSink)
+			continue;
+		g->vertexM[v].iMaxFromSink = value;
+		for (e = g->vertexM[v].predecessorList; e != NULL; e = e->pNextEdge)
+			bDirtyM[e->edge.iVertex] = TRUE;
+	}
+
+	maxTE = findMaxTE(g);
+	for (v = 0; v < n; v++)
+		g->vertexM[v].iTL = maxTE - g->vertexM[v].iMaxFromSink;
+}
+/************************** crashCut ***********************************
+int crashCut(Graph g, CrashNetwork *pNet, int iFromM[], int iToM[], int iChangeM[])
+Purpose:
+    Finds the least costly way to change edges so that every critical 
+    path gets shorter.
+Parameters:
+    I   Graph g             Pointer to a graphImp with TE and TL computed
+    I/O CrashNetwork *pNet  normalM, crashM and slopeM of each edge.  capM
+                            is used for the flow.
+    O   int iFromM[]        FROM vertex of each edge to change
+    O   int iToM[]          TO vertex of each edge to change
+    O   int iChangeM[]      -1 to shorten the edge, 1 to lengthen it
+Notes:
+    The network has the critical edges plus a source with an edge to each
+    critical source vertex and a sink with an edge from each critical sink
+    vertex.  Each critical edge has an upper bound on its flow of its 
+    slope if it can still be shortened (else infinite:  more than the sum
+    of the slopes) and a lower bound of its slope if it can be lengthened
+    (it was shortened earlier), else 0.  The maximum flow with those 
+    bounds equals the minimum over the cuts of the upper bounds of the
+    forward edges less the lower bounds of the backward edges, which is
+    the cost of shortening the forward edges and lengthening the backward
+    ones.
+    The lower bounds are handled the usual way:  each edge's capacity is
+    its upper less its lower bound, an edge from the sink to the source
+    makes it a circulation, and a flow from a second source to a second
+    sink moves the lower bounds' flow.  Then the flow from the source to
+    the sink is increased.  If the lower bounds can't be met (only 
+    possible if an earlier step wasn't optimal), they are dropped.
+    The flows are found by Edmonds-Karp and the cut is between the 
+    vertices reachable from the source in the residual network and the 
+    rest.
+Returns:
+    Number of edges to change, or -1 if every cut has an edge that can't
+    be shortened.
+**********************************************************************************/
+int crashCut(Graph g, CrashNetwork *pNet, int iFromM[], int iToM[], int iChangeM[])
+{
+	int iParentM[MAX_VERTICES + 4];     // vertex before each on the path (-1 if not reached)
+	Weight excessM[MAX_VERTICES + 2];   // lower bound flow into less out of each
+	int n = g->iNumVertices;
+	int iSource = n;
+	int iSink = n + 1;
+	int iLowerSource = n + 2;           // second source and sink for the lower bounds
+	int iLowerSink = n + 3;
+	int bLower;                         // TRUE while the lower bounds are used
+	Weight infinite = 1;
+	Weight required;                    // flow needed to meet the lower bounds
+	Weight flow;
+	Weight lower;
+	Weight maxTE = findMaxTE(g);
+	int iNumCut = 0;
+	int u;
+	int v;
+	EdgeNode *e;
+
+	for (u = 0; u < n; u++)
+	{
+		for (e = g->vertexM[u].successorList; e != NULL; e = e->pNextEdge)
+			infinite += pNet->slopeM[u][e->edge.iVertex];
+	}
+	for (bLower = TRUE; ; bLower = FALSE)
+	{
+		for (u = 0; u < n + 4; u++)
+		{
+			for (v = 0; v < n + 4; v++)
+				pNet->capM[u][v] = 0;
+		}
+		for (u = 0; u < n + 2; u++)
+			excessM[u] = 0;
+		for (u = 0; u < n; u++)
+		{
+			if (!WEIGHT_EQUAL(g->vertexM[u].iMaxFromSource, g->vertexM[u].iTL))
+				continue;
+			if (g->vertexM[u].predecessorList == NULL)
+				pNet->capM[iSource][u] = infinite;
+			if (g->vertexM[u].successorList == NULL 
+				&& WEIGHT_EQUAL(g->vertexM[u].iMaxFromSource, maxTE))
+				pNet->capM[u][iSink] = infinite;
+			for (e = g->vertexM[u].successorList; e != NULL; e = e->pNextEdge)
+			{
+				v = e->edge.iVertex;
+				if (!isCriticalEdge(g, u, e->edge))
+					continue;
+				lower = bLower && e->edge.iPath < pNet->normalM[u][v] ? pNet->slopeM[u][v] : 0;
+				pNet->capM[u][v] = (e->edge.iPath > pNet->crashM[u][v] ? pNet->slopeM[u][v] 
+					: infinite) - lower;
+				excessM[v] += lower;
+				excessM[u] -= lower;
+			}
+		}
+		if (!bLower)
+			break;
+		// meet the lower bounds with a circulation through the sink and source
+		pNet->capM[iSink][iSource] = infinite;
+		required = 0;
+		for (u = 0; u < n + 2; u++)
+		{
+			if (excessM[u] > 0)
+			{
+				pNet->capM[iLowerSource][u] = excessM[u];
+				required += excessM[u];
+			}
+			else
+				pNet->capM[u][iLowerSink] = -excessM[u];
+		}
+		if (crashMaxFlow(pNet, n + 4, iLowerSource, iLowerSink, infinite, iParentM) < required)
+			continue;                   // can't be met:  try again without them
+		// the circulation's flow through the sink to source edge is the flow so far
+		flow = infinite - pNet->capM[iSink][iSource];
+		pNet->capM[iSink][iSource] = 0;
+		pNet->capM[iSource][iSink] = 0;
+		for (u = 0; u < n + 4; u++)
+		{
+			pNet->capM[u][iLowerSource] = pNet->capM[iLowerSource][u] = 0;
+			pNet->capM[u][iLowerSink] = pNet->capM[iLowerSink][u] = 0;
+		}
+		break;
+	}
+	if (!bLower)
+		flow = 0;
+	flow += crashMaxFlow(pNet, n + 4, iSource, iSink, infinite - flow, iParentM);
+	if (flow >= infinite)
+		return -1;
+
+	// iParentM marks the vertices reachable from the source
+	for (u = 0; u < n; u++)
+	{
+		for (e = g->vertexM[u].successorList; e != NULL; e = e->pNextEdge)
+		{
+			v = e->edge.iVertex;
+			if (!isCriticalEdge(g, u, e->edge) || (iParentM[u] < 0) == (iParentM[v] < 0))
+				continue;
+			if (iParentM[u] >= 0)
+				iChangeM[iNumCut] = -1;
+			else if (e->edge.iPath < pNet->normalM[u][v])
+				iChangeM[iNumCut] = 1;
+			else
+				continue;
+			iFromM[iNumCut] = u;
+			iToM[iNumCut++] = v;
+		}
+	}
+	return iNumCut;
+}
+/************************** crashMaxFlow ***********************************
+Weight crashMaxFlow(CrashNetwork *pNet, int iNumNodes, int iSource, int iSink
+    , Weight limit, int iParentM[])
+Purpose:
+    Adds as much flow as it can (up to a limit) from a source to a sink of
+    a crashCut network.
+Parameters:
+    I/O CrashNetwork *pNet  Network with its residual capacities in capM
+    I   int iNumNodes       Number of nodes
+    I   int iSource         Where the flow starts
+    I   int iSink           Where it ends
+    I   Weight limit        Stop once this much flow has been added
+    O   int iParentM[]      Node before each node on its path from the 
+                            source in the last search (-1 for nodes that 
+                            can't be reached).  If the flow is below the 
+                            limit, these are the source's side of a 
+                            minimum cut.
+Notes:
+    Edmonds-Karp:  each augmenting path is a shortest one, found by 
+    breadth first search.
+Returns:
+    The flow added.
+**********************************************************************************/
+Weight crashMaxFlow(CrashNetwork *pNet, int iNumNodes, int iSource, int iSink
+	, Weight limit, int iParentM[])
+{
+	int iQueueM[MAX_VERTICES + 4];
+	int iNumQueued;
+	int iNext;
+	Weight flow = 0;
+	Weight bottleneck;
+	int u;
+	int v;
+	while (flow < limit)
+	{
+		for (v = 0; v < iNumNodes; v++)
+			iParentM[v] = -1;
+		iParentM[iSource] = iSource;
+		iQueueM[0] = iSource;
+		iNumQueued = 1;
+		for (iNext = 0; iNext < iNumQueued && iParentM[iSink] < 0; iNext++)
+		{
+			u = iQueueM[iNext];
+			for (v = 0; v < iNumNodes; v++)
+			{
+				if (iParentM[v] >= 0 || pNet->capM[u][v] <= 0)
+					continue;
+				iParentM[v] = u;
+				iQueueM[iNumQueued++] = v;
+			}
+		}
+		if (iParentM[iSink] < 0)
+			break;
+		bottleneck = limit - flow;
+		for (v = iSink; v != iSource; v = iParentM[v])
+		{
+			if (pNet->capM[iParentM[v]][v] < bottleneck)
+				bottleneck = pNet->capM[iParentM[v]][v];
+		}
+		for (v = iSink; v != iSource; v = iParentM[v])
+		{
+			pNet->capM[iParentM[v]][v] -= bottleneck;
+			pNet->capM[v][iParentM[v]] += bottleneck;
+		}
+		flow += bottleneck;
+	}
+	return flow;
+}
+/* end of p6 student written functions */
+
+int main(int argc, char *argv[])
+{
+    int iRun = 0;
+    int rc;
+    int iNumRemoved;                    // redundant edges removed
+    Options options;                    // from the command switches
+    ResultCache cache;                  // results of earlier runs (-c)
+    PathList paths;                     // critical paths from or for the cache
+    struct Data dataM[MAX_EDGES + 1];   // edges from the data (plus the terminating edge)
+    PertContext ctx;
+    Crash crashM[MAX_EDGES + 1];        // crash durations and slopes (-k)
+    FILE *pScenarioFile = NULL;         // what-if scenarios (-w)
+    Override *overrideM = NULL;         // one set of overrides from it
+    ScenarioResult *scenarioResultM = NULL;
+    int iNumOverrides;
+    int iNumScenarios;
+    Graph graph;
+    char szMessage[OOC_MESSAGE_SIZE];   // why an out-of-core run failed (-x)
+    processCommandSwitches(argc, argv, &options);
+    if (options.pszSocketPath != NULL)
+    {   // only returns if the server can't run
+        rc = runServer(options.pszSocketPath);
+        ErrExit(rc, "server on '%s' failed", options.pszSocketPath);
+    }
+    if (options.pszOutOfCorePath != NULL)
+    {
+        rc = runOutOfCore(options.pszOutOfCorePath, options.iMemoryMB, szMessage);
+        if (rc != PERT_OK)
+            ErrExit(rc, "out-of-core run failed: %s", szMessage);
+        return 0;
+    }
+    ctx = newPertContext();
+    if (ctx == NULL)
+        ErrExit(ERR_ALGORITHM, "malloc for PertContext failed");
+    if (options.pszCachePath != NULL)
+    {
+        rc = openResultCache(options.pszCachePath, options.iCacheEntries, &cache);
+        if (rc != PERT_OK)
+            ErrExit(rc, "can't use cache file '%s'", options.pszCachePath);
+    }
+    if (options.pszScenarioPath != NULL)
+    {
+        pScenarioFile = fopen(options.pszScenarioPath, "r");
+        if (pScenarioFile == NULL)
+            ErrExit(ERR_COMMAND_LINE, "can't open scenario file '%s'", options.pszScenarioPath);
+        overrideM = (Override *)malloc(MAX_OVERRIDES * sizeof(Override));
+        scenarioResultM = (ScenarioResult *)malloc(MAX_SCENARIOS * sizeof(ScenarioResult));
+        if (overrideM == NULL || scenarioResultM == NULL)
+            ErrExit(ERR_ALGORITHM, "malloc for scenarios failed");
+    }
+    if (options.iFormat == FORMAT_BINARY)
+        setBinaryOutput();
+    else if (options.iFormat == FORMAT_CSV)
+        printf("record,graph,vertex,te,tl,slack,critical,path\n");
+    while (getGraphData(dataM, options.bCrash ? crashM : NULL) == TRUE)
+    {
+        // Build the graph from the dataM array
+        rc = pertBuild(ctx, dataM);
+        if (rc != PERT_OK)
+            ErrExit(rc, "%s", pertErrorMessage(ctx));
+        graph = pertGraph(ctx);
+        iRun++;
+        if (options.bRemoveRedundant)
+        {
+            rc = pertRemoveRedundantEdges(ctx, &iNumRemoved);
+            if (rc != PERT_OK)
+                ErrExit(rc, "%s", pertErrorMessage(ctx));
+            // keep the machine-readable formats' records unchanged
+            fprintf(options.iFormat == FORMAT_TEXT ? stdout : stderr
+                , "Graph #%2d: removed %d redundant edge(s)\n", iRun, iNumRemoved);
+        }
+        if (options.iFormat == FORMAT_TEXT)
+            printGraph(iRun, "Initial", graph);
+
+        // Compute TE, TL and the critical paths unless an identical 
+        // graph's are in the cache
+        if (options.pszCachePath == NULL || !lookupResultCache(&cache, ctx, &paths))
+        {
+            rc = pertCompute(ctx);
+            if (rc != PERT_OK)
+                ErrExit(rc, "%s", pertErrorMessage(ctx));
+            if (options.pszCachePath != NULL)
+            {
+                listCriticalPaths(graph, &paths);
+                storeResultCache(&cache, ctx, &paths);
+            }
+        }
+
+        // Print TE, TL and critical paths
+        writeResults(options.iFormat, iRun, graph
+            , options.pszCachePath != NULL ? &paths : NULL);
+
+        // Print this graph's set of what-if scenarios (before -k changes weights)
+        if (pScenarioFile != NULL)
+        {
+            iNumOverrides = getScenarioData(pScenarioFile, overrideM, &iNumScenarios);
+            if (iNumOverrides >= 0 && iNumScenarios > 0)
+            {
+                rc = pertEvaluateScenarios(ctx, overrideM, iNumOverrides, iNumScenarios
+                    , scenarioResultM);
+                if (rc != PERT_OK)
+                    ErrExit(rc, "%s", pertErrorMessage(ctx));
+                printScenarioResults(iRun, graph, scenarioResultM, iNumScenarios);
+            }
+        }
+
+        // Print the least cost way to shorten the project
+        if (options.bCrash)
+        {
+            printf("Graph #%2d: Crashing curve\n", iRun);
+            printf("%5s %4s\t%s\n", "MaxTE", "Cost", "CHANGED EDGES (NEW WEIGHT)");
+            rc = pertCrash(ctx, crashM, 0, printCrashStep, NULL);
+            if (rc != PERT_OK)
+                ErrExit(rc, "%s", pertErrorMessage(ctx));
+        }
+
+        // let the consumer have this graph's results before reading the next
+        fflush(stdout);
+    }
+    if (options.pszCachePath != NULL)
+        closeResultCache(&cache);
+    if (pScenarioFile != NULL)
+    {
+        fclose(pScenarioFile);
+        free(overrideM);
+        free(scenarioResultM);
+    }
+    freePertContext(ctx);
+    return 0;
+}
+/******************** processCommandSwitches *****************************
+    void processCommandSwitches(int argc, char *argv[], Options *pOptions)
+Purpose:
+    Checks the syntax of command line arguments and returns the 
+    options they specify.
+Parameters:
+    I   int argc                Count of command line arguments
+    I   char *argv[]            Array of command line arguments
+    O   Options *pOptions       The options:
+                                iFormat - output format
+                                    -f text     FORMAT_TEXT (default)
+                                    -f csv      FORMAT_CSV
+                                    -f jsonl    FORMAT_JSONL
+                                    -f bin      FORMAT_BINARY
+                                bRemoveRedundant - TRUE for -t
+                                pszSocketPath - -s socketPath runs the
+                                    server (see runServer), else NULL
+                                pszCachePath - -c cacheFile to use a
+                                    result cache, else NULL
+                                iCacheEntries - -n entries in a new cache
+                                    file (default CACHE_ENTRIES)
+                                bCrash - TRUE for -k
+                                pszScenarioPath - -w scenarioFile to 
+                                    evaluate what-if scenarios, else NULL
+Notes:
+    If an argument is invalid, exitUsage is called to show the usage 
+    and exit.  -? shows the usage.
+Returns:
+    n/a
+**************************************************************************/
+void processCommandSwitches(int argc, char *argv[], Options *pOptions)
+{
+    int i;
+    pOptions->iFormat = FORMAT_TEXT;
+    pOptions->bRemoveRedundant = FALSE;
+    pOptions->pszSocketPath = NULL;
+    pOptions->pszCachePath = NULL;
+    pOptions->iCacheEntries = CACHE_ENTRIES;
+    pOptions->bCrash = FALSE;
+    pOptions->pszScenarioPath = NULL;
+    pOptions->pszOutOfCorePath = NULL;
+    pOptions->iMemoryMB = OOC_MEMORY_MB;
+    for (i = 1; i < argc; i++)
+    {
+        // check for a switch
+        if (argv[i][0] != '-')
+            exitUsage(i, ERR_EXPECTED_SWITCH, argv[i]);
+        // determine which switch it is
+        switch (argv[i][1])
+        {
+            case 'f':                   // Output format
+                if (++i >= argc)
+                    exitUsage(i, ERR_MISSING_ARGUMENT, "-f");
+                if (strcmp(argv[i], "text") == 0)
+                    pOptions->iFormat = FORMAT_TEXT;
+                else if (strcmp(argv[i], "csv") == 0)
+                    pOptions->iFormat = FORMAT_CSV;
+                else if (strcmp(argv[i], "jsonl") == 0)
+                    pOptions->iFormat = FORMAT_JSONL;
+                else if (strcmp(argv[i], "bin") == 0)
+                    pOptions->iFormat = FORMAT_BINARY;
+                else
+                    exitUsage(i, "unknown output format", argv[i]);
+                break;
+            case 't':                   // Transitive reduction
+                pOptions->bRemoveRedundant = TRUE;
+                break;
+            case 's':                   // Server socket
+                if (++i >= argc)
+                    exitUsage(i, ERR_MISSING_ARGUMENT, "-s");
+#ifdef _WIN32
+                exitUsage(i, "server mode needs Unix domain sockets", argv[i]);
+#endif
+                pOptions->pszSocketPath = argv[i];
+                break;
+            case 'c':                   // Result cache file
+                if (++i >= argc)
+                    exitUsage(i, ERR_MISSING_ARGUMENT, "-c");
+#ifdef _WIN32
+                exitUsage(i, "the result cache needs mmap", argv[i]);
+#endif
+                pOptions->pszCachePath = argv[i];
+                break;
+            case 'n':                   // Result cache entries
+                if (++i >= argc)
+                    exitUsage(i, ERR_MISSING_ARGUMENT, "-n");
+                if (sscanf(argv[i], "%d", &pOptions->iCacheEntries) != 1
+                    || pOptions->iCacheEntries <= 0)
+                    exitUsage(i, "invalid number of cache entries", argv[i]);
+                break;
+            case 'k':                   // Crashing curve
+                pOptions->bCrash = TRUE;
+                break;
+            case 'w':                   // What-if scenario file
+                if (++i >= argc)
+                    exitUsage(i, ERR_MISSING_ARGUMENT, "-w");
+                pOptions->pszScenarioPath = argv[i];
+                break;
+            case 'x':                   // Out-of-core result file
+                if (++i >= argc)
+                    exitUsage(i, ERR_MISSING_ARGUMENT, "-x");
+#ifdef _WIN32
+                exitUsage(i, "out-of-core mode needs pread and mmap", argv[i]);
+#endif
+                pOptions->pszOutOfCorePath = argv[i];
+                break;
+            case 'm':                   // Out-of-core memory budget
+                if (++i >= argc)
+                    exitUsage(i, ERR_MISSING_ARGUMENT, "-m");
+                if (sscanf(argv[i], "%d", &pOptions->iMemoryMB) != 1
+                    || pOptions->iMemoryMB <= 0)
+                    exitUsage(i, "invalid number of megabytes", argv[i]);
+                break;
+            case '?':
+                exitUsage(USAGE_ONLY, "", "");
+                break;
+            default:
+                exitUsage(i, ERR_EXPECTED_SWITCH, argv[i]);
+        }
+    }
+    if (pOptions->bCrash && pOptions->iFormat != FORMAT_TEXT)
+        exitUsage(USAGE_ERR, "-k only supports", "-f text");
+    if (pOptions->pszScenarioPath != NULL && pOptions->iFormat != FORMAT_TEXT)
+        exitUsage(USAGE_ERR, "-w only supports", "-f text");
+    // removed edges could be made critical by crashing
+    if (pOptions->bCrash && pOptions->bRemoveRedundant)
+        exitUsage(USAGE_ERR, "-k can't be used with", "-t");
+    // the out-of-core input and results are different
+    if (pOptions->pszOutOfCorePath != NULL
+        && (pOptions->iFormat != FORMAT_TEXT || pOptions->bRemoveRedundant
+            || pOptions->pszSocketPath != NULL || pOptions->pszCachePath != NULL
+            || pOptions->bCrash || pOptions->pszScenarioPath != NULL))
+        exitUsage(USAGE_ERR, "-x can't be used with", "-f, -t, -s, -c, -k or -w");
+}
+/******************** getGraphData **************************************
+  int getGraphData(struct Data dataM[], Crash crashM[])
+Purpose:
+    Populates an array of edges with data from stdin.  The array is 
+    terminated when EOF or a 0 0 0 is encountered in the data. 
+Parameters:
+    O   struct Data dataM[]     An array of edges (to, from, path weight)
+                                with room for MAX_EDGES + 1 entries.
+    O   Crash crashM[]          If not NULL, the crash weight and cost 
+                                slope of each edge that has them (room for
+                                MAX_EDGES + 1 entries, terminated by a 
+                                cFrom of '\0').
+Notes:
+    - The array of edges is terminated by an edge having a from vertex
+      equal to the character '0'.
+    - The returned array is always terminated by a cFrom of '\0', even
+      when the last graph in the file is ended by EOF.
+Returns:
+    TRUE - data was read to populate the array of vertices.
+    FALSE - no data found.
+**************************************************************************/
+int getGraphData(struct Data dataM[], Crash crashM[])
+{
+    char szInput[100];
+    int i = 0;
+    int iNumCrash = 0;
+    int iScanfCnt;
+    Weight crash;                       // optional crash weight
+    Weight slope;                       // and cost slope
+    dataM[0].cFrom = '\0';
+    if (crashM != NULL)
+        crashM[0].cFrom = '\0';
+    while (fgets(szInput, 50, stdin) != NULL)
+    {
+        iScanfCnt = sscanf(szInput, "%c %c %" WEIGHT_SCN " %" WEIGHT_SCN " %" WEIGHT_SCN
+            , &dataM[i].cFrom, &dataM[i].cTo, &dataM[i].iPath
+            , &crash, &slope);
+        if (iScanfCnt < 3)
+            ErrExit(ERR_BAD_INPUT, " Found: '%s', scanf count is %d", szInput, iScanfCnt);
+        if (dataM[i].cFrom == '0')
+        {
+            dataM[i].cFrom = '\0';
+            break;
+        }
+        if (i >= MAX_EDGES)
+            ErrExit(ERR_BAD_INPUT, "too many edges");
+        if (crashM != NULL && iScanfCnt == 4)
+            ErrExit(ERR_BAD_INPUT, " Found: '%s', expected a crash weight and cost slope", szInput);
+        if (crashM != NULL && iScanfCnt == 5)
+        {
+            crashM[iNumCrash].cFrom = dataM[i].cFrom;
+            crashM[iNumCrash].cTo = dataM[i].cTo;
+            crashM[iNumCrash].crash = crash;
+            crashM[iNumCrash].slope = slope;
+            iNumCrash++;
+            crashM[iNumCrash].cFrom = '\0';
+        }
+        i++;
+        dataM[i].cFrom = '\0';
+    }
+    return i > 0;
+}
+/******************** newGraph **************************************
+    Graph newGraph()
+Purpose:
+    Allocates a GraphImp and initializes its data.  It returns a
+    Graph. 
+Parameters:
+    n/a
+Notes:
+    - Uses malloc to allocate a GraphImp.  It also makes certain
+      that malloc didn't fail.
+    - Initializes iNumvetices to 0.
+    - Initializes the array of vertices to zero bytes.
+    - 
+Returns:
+    Graph - the newly allocated graph.
+**************************************************************************/
+Graph newGraph()
+{
+    Graph g = (Graph)malloc(sizeof(GraphImp));
+    if (g == NULL)
+        ErrExit(ERR_ALGORITHM, "malloc for Graph failed");
+    g->iNumVertices = 0;
+    memset(g->vertexM, '\0',  sizeof(Vertex)*MAX_VERTICES);
+    return g;
+}
+/******************** getScenarioData **************************************
+  int getScenarioData(FILE *pFile, Override overrideM[], int *piNumScenarios)
+Purpose:
+    Reads the next set of what-if overrides from a scenario file (-w).
+    Graph #n uses the n-th set.
+Parameters:
+    I   FILE *pFile             The scenario file.
+    O   Override overrideM[]    The overrides (room for MAX_OVERRIDES).
+    O   int *piNumScenarios     Largest scenario number in the set.
+Notes:
+    - Each line gives an edge's weight in one scenario:
+          Scenario From To PathWeight
+          %d       %c   %c %d
+      Scenarios are numbered from 1 in the file and from 0 in overrideM
+      (as pertEvaluateScenarios expects).  A scenario without lines is
+      the graph unchanged.
+    - Each set is terminated by a record having 0 0 0 0 or by EOF.
+Returns:
+    >= 0 - number of overrides in the set.
+    -1 - no data found.
+**************************************************************************/
+int getScenarioData(FILE *pFile, Override overrideM[], int *piNumScenarios)
+{
+    char szInput[100];
+    int i = 0;
+    int bFound = FALSE;                 // TRUE once a record is read
+    int iScanfCnt;
+    *piNumScenarios = 0;
+    while (fgets(szInput, 100, pFile) != NULL)
+    {
+        bFound = TRUE;
+        if (i >= MAX_OVERRIDES)
+            ErrExit(ERR_BAD_INPUT, "too many scenario overrides");
+        iScanfCnt = sscanf(szInput, "%d %c %c %" WEIGHT_SCN
+            , &overrideM[i].iScenario, &overrideM[i].cFrom, &overrideM[i].cTo
+            , &overrideM[i].iPath);
+        if (iScanfCnt < 1)
+            ErrExit(ERR_BAD_INPUT, " Found: '%s', scanf count is %d", szInput, iScanfCnt);
+        if (overrideM[i].iScenario == 0)
+            break;
+        if (iScanfCnt < 4)
+            ErrExit(ERR_BAD_INPUT, " Found: '%s', scanf count is %d", szInput, iScanfCnt);
+        if (overrideM[i].iScenario < 0 || overrideM[i].iScenario > MAX_SCENARIOS)
+            ErrExit(ERR_BAD_INPUT, " Found: '%s', invalid scenario", szInput);
+        if (overrideM[i].iScenario > *piNumScenarios)
+            *piNumScenarios = overrideM[i].iScenario;
+        overrideM[i].iScenario--;
+        i++;
+    }
+    return bFound ? i : -1;
+}
+/******************** buildGraph **************************************
+    Graph buildGraph(struct Data dataM[])
+Purpose:
+    Allocates a graph and builds it from an array of edges using loadGraph.
+Parameters:
+    I   struct Data dataM[]     An array of edges (to, from, path weight)
+Notes:
+    - Exits with ERR_BAD_INPUT if there are too many vertices.
+Returns:
+    Graph - the newly allocated and populated graph.
+**************************************************************************/
+Graph buildGraph(struct Data dataM[])
+{
+    Graph graph = newGraph();
+    if (loadGraph(graph, dataM) != PERT_OK)
+        ErrExit(ERR_BAD_INPUT, "too many vertices");
+    return graph;
+}
+/******************** loadGraph **************************************
+    int loadGraph(Graph graph, struct Data dataM[])
+Purpose:
+    Builds a graph from an array of edges.  The Graph is represented by
+    an array of vertices and a double adjacency list.
+Parameters:
+    I/O Graph graph             The graph to (re)build.  Any vertices it
+                                had are cleared first.
+    I   struct Data dataM[]     An array of edges (to, from, path weight)
+
+Notes:
+    - The array of edges is terminated by an edge having a from vertex
+      equal to the character '0'.
+    - Labels are interned through a table indexed by the label, so each
+      edge costs O(1) instead of a linear searchVertices.  Vertices are
+      still numbered in order of first appearance.
+    - The lists are built with counting sorts into the graph's edgeNodeM:
+      the successors are sorted by TO and then stably by FROM, which 
+      groups them by FROM vertex with ascending TO vertices (the order 
+      searchLL expects).  The predecessors are done the other way
+      around.  A repeated edge keeps its first path weight.
+    - Normally, this routine checks to make certain that the input did not
+      include a cycle, but since that code wasn't included, the check
+      has been commented out.
+    - Nothing is allocated, so a graph can be reloaded over and over.
+Returns:
+    PERT_OK - the graph was built.
+    ERR_BAD_INPUT - there are more than MAX_VERTICES vertices.
+**************************************************************************/
+int loadGraph(Graph graph, struct Data dataM[])
+{
+    int i;
+    int iNumData;                   // number of edges in dataM
+    int iLabelM[256];               // vertex subscript for each label (-1 if none)
+    int iFromM[MAX_EDGES];          // FROM vertex of each edge in dataM
+    int iToM[MAX_EDGES];            // TO vertex of each edge in dataM
+    int iOrderM[MAX_EDGES];         // subscripts of dataM in list order
+    int iTmpM[MAX_EDGES];           // result of the first counting sort
+
+    memset(graph->vertexM, '\0', sizeof(Vertex)*graph->iNumVertices);
+    graph->iNumVertices = 0;
+    graph->iNumEdges = 0;
+    graph->ullEdgeHash = 0;
+    memset(iLabelM, -1, sizeof(iLabelM));
+
+    // Go through the array of edges until a From of '\0' is encountered
+    for (iNumData = 0; iNumData < MAX_EDGES; iNumData++)
+    {
+        if (dataM[iNumData].cFrom == '\0')
+            break;
+        iFromM[iNumData] = internLabel(graph, iLabelM, dataM[iNumData].cFrom);
+        iToM[iNumData] = internLabel(graph, iLabelM, dataM[iNumData].cTo);
+        if (iFromM[iNumData] < 0 || iToM[iNumData] < 0)
+            return ERR_BAD_INPUT;
+        iOrderM[iNumData] = iNumData;
+    }
+
+    // successor lists:  by TO, then by FROM
+    countingSortEdges(iToM, iOrderM, iTmpM, iNumData, graph->iNumVertices);
+    countingSortEdges(iFromM, iTmpM, iOrderM, iNumData, graph->iNumVertices);
+    graph->iNumEdges = linkEdgeNodes(graph, &graph->edgeNodeM[0], iOrderM, iNumData
+        , iFromM, iToM, dataM, TRUE);
+
+    // predecessor lists:  by FROM, then by TO
+    for (i = 0; i < iNumData; i++)
+        iOrderM[i] = i;
+    countingSortEdges(iFromM, iOrderM, iTmpM, iNumData, graph->iNumVertices);
+    countingSortEdges(iToM, iTmpM, iOrderM, iNumData, graph->iNumVertices);
+    linkEdgeNodes(graph, &graph->edgeNodeM[graph->iNumEdges], iOrderM, iNumData
+        , iToM, iFromM, dataM, FALSE);
+//    if (!checkCycle(graph))
+//        ErrExit(ERR_BAD_INPUT, "Cycle in Graph");
+    return PERT_OK;
+}
+/******************** hashEdge **************************************
+   uint64_t hashEdge(char cFrom, char cTo, Weight iPath)
+Purpose:
+    Hashes an edge for a graph's ullEdgeHash.
+Parameters:
+    I   char cFrom              Label of the FROM vertex.
+    I   char cTo                Label of the TO vertex.
+    I   Weight iPath            The edge's path weight.
+Notes:
+    - A graph's hash is the sum of its edges' hashes, so it doesn't depend
+      on the order of the edges and an edge can be taken out by 
+      subtracting its hash.  The bits of each edge are mixed with the
+      splitmix64 finalizer so the sum doesn't cancel out simple patterns.
+Returns:
+    the edge's hash.
+**************************************************************************/
+uint64_t hashEdge(char cFrom, char cTo, Weight iPath)
+{
+    uint64_t ullPath = 0;
+    uint64_t h;
+    memcpy(&ullPath, &iPath, sizeof(Weight));
+    h = ((uint64_t)(unsigned char)cFrom << 8 | (unsigned char)cTo) * 0x9E3779B97F4A7C15ULL;
+    h ^= ullPath + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+/******************** internLabel **************************************
+   int internLabel(Graph graph, int iLabelM[], char cLabel)
+Purpose:
+    Returns the subscript of the vertex having the specified label, 
+    adding the vertex to the graph if it isn't there yet.
+Parameters:
+    I/O Graph graph             The graph being built.
+    I/O int iLabelM[]           Vertex subscript for each of the 256 labels.
+                                -1 means the label hasn't been seen.
+    I   char cLabel             The vertex's label.
+Notes:
+    - Doesn't add the vertex if the graph would exceed MAX_VERTICES.
+Returns:
+    >= 0 - subscript in the array of vertices.
+    -1 - too many vertices
+**************************************************************************/
+int internLabel(Graph graph, int iLabelM[], char cLabel)
+{
+    int *piVertex = &iLabelM[(unsigned char)cLabel];
+    if (*piVertex == -1)
+    {   // not found, so insert the vertex in the array
+        if (graph->iNumVertices >= MAX_VERTICES)
+            return -1;
+        *piVertex = graph->iNumVertices;
+        graph->iNumVertices++;
+        graph->vertexM[*piVertex].cLabel = cLabel;
+    }
+    return *piVertex;
+}
+/******************** countingSortEdges **************************************
+   void countingSortEdges(int iKeyM[], int iInM[], int iOutM[]
+        , int iNumEdges, int iNumKeys)
+Purpose:
+    Stable counting sort of edge subscripts by a vertex subscript key.
+Parameters:
+    I   int iKeyM[]             Key (a vertex subscript) for each edge.
+    I   int iInM[]              Edge subscripts to be sorted.
+    O   int iOutM[]             Edge subscripts sorted by iKeyM[].
+    I   int iNumEdges           Number of entries in iInM.
+    I   int iNumKeys            Keys are in the range 0 .. iNumKeys - 1.
+Notes:
+    - Equal keys keep the order they had in iInM, so two passes give a
+      sort by the second key and then the first key.
+Returns:
+    n/a
+**************************************************************************/
+void countingSortEdges(int iKeyM[], int iInM[], int iOutM[], int iNumEdges, int iNumKeys)
+{
+    int iStartM[MAX_VERTICES + 1];  // where each key's edges begin in iOutM
+    int i;
+    memset(iStartM, 0, sizeof(int) * (iNumKeys + 1));
+    for (i = 0; i < iNumEdges; i++)
+        iStartM[iKeyM[iInM[i]] + 1]++;
+    for (i = 1; i <= iNumKeys; i++)
+        iStartM[i] += iStartM[i - 1];
+    for (i = 0; i < iNumEdges; i++)
+        iOutM[iStartM[iKeyM[iInM[i]]]++] = iInM[i];
+}
+/******************** linkEdgeNodes **************************************
+   int linkEdgeNodes(Graph graph, EdgeNode nodeM[], int iOrderM[], int iNumEdges
+        , int iOwnerM[], int iOtherM[], struct Data dataM[], int bSuccessor)
+Purpose:
+    Fills consecutive EdgeNodes from sorted edges and links them into
+    either the successor lists or the predecessor lists.
+Parameters:
+    I/O Graph graph             The graph being built.
+    O   EdgeNode nodeM[]        Where to place the EdgeNodes.
+    I   int iOrderM[]           Subscripts of dataM grouped by iOwnerM and
+                                ascending by iOtherM within a group.
+    I   int iNumEdges           Number of entries in iOrderM.
+    I   int iOwnerM[]           Vertex whose list receives each edge.
+    I   int iOtherM[]           Vertex stored in each edge.
+    I   struct Data dataM[]     The edges (for the path weights).
+    I   int bSuccessor          TRUE - link into the successorList
+                                FALSE - link into the predecessorList
+Notes:
+    - Since the edges are sorted, a repeated edge is next to its first
+      occurrence and is skipped.
+    - Each successor edge is added into the graph's ullEdgeHash.
+Returns:
+    number of EdgeNodes used.
+**************************************************************************/
+int linkEdgeNodes(Graph graph, EdgeNode nodeM[], int iOrderM[], int iNumEdges
+    , int iOwnerM[], int iOtherM[], struct Data dataM[], int bSuccessor)
+{
+    int i;
+    int iEdge;                      // subscript in dataM
+    int iNumNodes = 0;              // EdgeNodes used so far
+    Vertex *pVertex;
+    for (i = 0; i < iNumEdges; i++)
+    {
+        iEdge = iOrderM[i];
+        if (iNumNodes > 0
+            && nodeM[iNumNodes - 1].edge.iVertex == iOtherM[iEdge]
+            && iOwnerM[iOrderM[i - 1]] == iOwnerM[iEdge])
+            continue;               // repeated edge
+        nodeM[iNumNodes].edge.iVertex = iOtherM[iEdge];
+        nodeM[iNumNodes].edge.iPath = dataM[iEdge].iPath;
+        nodeM[iNumNodes].pNextEdge = NULL;
+        if (bSuccessor)
+            graph->ullEdgeHash += hashEdge(dataM[iEdge].cFrom, dataM[iEdge].cTo, dataM[iEdge].iPath);
+        if (iNumNodes > 0 && iOwnerM[iOrderM[i - 1]] == iOwnerM[iEdge])
+            nodeM[iNumNodes - 1].pNextEdge = &nodeM[iNumNodes];
+        else
+        {   // first edge for this vertex starts its list
+            pVertex = &graph->vertexM[iOwnerM[iEdge]];
+            if (bSuccessor)
+                pVertex->successorList = &nodeM[iNumNodes];
+            else
+                pVertex->predecessorList = &nodeM[iNumNodes];
+        }
+        iNumNodes++;
+    }
+    return iNumNodes;
+}
+/******************** searchVertices **************************************
+   int searchVertices(Graph graph, char cVertex)
+Purpose:
+    Searches the graph's array of vertices for the specified vertex.  If 
+    found, it returns the subscript.  If not found, it returns -1.
+Parameters:
+    I   Graph graph             A directed graph represented by a double
+                                adjacency list an an array of vertices.
+    I   char cVertex            The vertex's label to be found.
+Notes:
+    - this just uses a linear search.  It can be greatly improved using
+      a binary search (if sorted) or hashing
+Returns:
+    >= 0 - subscript in the array of vertices if the vertex label is found 
+    -1 - not found
+**************************************************************************/
+int searchVertices(Graph graph, char cVertex)
+{
+    int i;
+    for (i = 0; i < graph->iNumVertices; i++)
+    {
+        if (cVertex == graph->vertexM[i].cLabel)
+            return i;
+    }
+    return -1;
+}
+/******************** printGraph **************************************
    void printGraph(int iRun, char *pszSubject, Graph graph)
 Purpose:
-    Prints a graph which is represensted by a double adjacency list.
-    When printing the information about a vertex, it prints the PERT
-    TE and TL.  For each vertex, it prints:
-        vertex label
-        TE
-        TL
-        predecessors
-        successors
+    Prints a graph which is represensted by a double adjacency list.
+    When printing the information about a vertex, it prints the PERT
+    TE and TL.  For each vertex, it prints:
+        vertex label
+        TE
+        TL
+        predecessors
+        successors
+Parameters:
+    I   int iRun                Identifies which graph is being displayed. 
+    I   char *pszSubject        A message to display about this graph.
+    I   Graph graph             A directed graph represented by a double
+                                adjacency list.  
+Notes:
+    - Since predecessors and successors are printed on the same line,
+      it uses the function printSpaces to help have all the lists of
+      predecessors appear in the same column.
+Returns:
+    n/a
+**************************************************************************/
+void printGraph(int iRun, char *pszSubject, Graph graph)
+{
+    int iv;
+    EdgeNode *e;
+    int iCnt;
+    // Print headings
+    printf("Graph #%2d: %s\n", iRun, pszSubject);
+    printf("%3s %2s %2s\t%-24s    %-24s\n"
+        , "Vtx", "TE", "TL", "SUCCESSORS", "PREDECESSORS");
+    // for each vertex in the graph
+    for (iv = 0; iv < graph->iNumVertices; iv++)
+    {
+        // print the vertex label, TE, and TL
+        printf("%c   %" WEIGHT_PRT " %" WEIGHT_PRT "\t", graph->vertexM[iv].cLabel
+            , graph->vertexM[iv].iMaxFromSource
+            , graph->vertexM[iv].iTL);
+        iCnt = 0;
+        // print each of its successors
+        for (e = graph->vertexM[iv].successorList; e != NULL; e = e->pNextEdge)
+        {
+            iCnt++;
+            printf("%c %" WEIGHT_PRT "  "
+                , graph->vertexM[e->edge.iVertex].cLabel
+                , e->edge.iPath);
+        }
+        // if it didn't have successors, print a "-"
+        if (iCnt == 0)
+        {
+            printf("-     ");
+            iCnt = 1;
+        }
+        // determine the variable-spaced amount for including spaces to get the 
+        // predecessor list to print in a specific column
+        printSpaces("      ", 4 - iCnt);
+        printf("    ");
+        iCnt = 0;
+        // Print each of its predecessors
+        for (e = graph->vertexM[iv].predecessorList; e != NULL; e = e->pNextEdge)
+        {
+            printf("%c %" WEIGHT_PRT " "
+                , graph->vertexM[e->edge.iVertex].cLabel
+                , e->edge.iPath);
+            iCnt++;
+        }
+        // if it didn't have predecessors, print a "-"
+        if (iCnt == 0)
+            printf("-");
+        printf("\n");
+    }
+}
+/******************** printSpaces **************************************
+void printSpaces(char szSpaces[], int iRepeat)
+Purpose:
+    Prints spaces across a line of output to help with consistent columns.
+Parameters:
+    I   char szSpaces           A string of spaces to be printed
+    I   iRepeat                 The number of times to print that string
+                                of spaces.   
+Returns:
+    n/a
+**************************************************************************/
+void printSpaces(char szSpaces[], int iRepeat)
+{
+    int i;
+    for (i = 0; i < iRepeat; i++)
+    {
+        printf("%s", szSpaces);
+    }
+}
+/******************** writeResults **************************************
+   void writeResults(int iFormat, int iRun, Graph graph, PathList *pPaths)
+Purpose:
+    Writes the TE, TL and critical paths of a graph in the requested
+    output format.
+Parameters:
+    I   int iFormat             FORMAT_TEXT, FORMAT_CSV, FORMAT_JSONL or
+                                FORMAT_BINARY
+    I   int iRun                Identifies which graph is being written. 
+    I   Graph graph             A graph with TE and TL computed.
+    I   PathList *pPaths        Its critical paths from the result cache,
+                                or NULL to find them (see forEachListedPath).
+Notes:
+    - FORMAT_TEXT is the printGraph table followed by the critical paths.
+    - The other formats have one record per vertex (in vertexM order) 
+      followed by one record per critical path:
+      CSV       record,graph,vertex,te,tl,slack,critical,path
+                V,1,A,0,4,4,0,
+                P,1,,,,,,HECD
+      JSONL     {"graph":1,"vertex":"A","te":0,"tl":4,"slack":4,"critical":false}
+                {"graph":1,"criticalPath":["H","E","C","D"]}
+      binary    'V' int graph, char label, Weight te, Weight tl, Weight slack,
+                    char critical
+                'P' int graph, unsigned char length, char labels[length]
+      Binary fields are in native byte order without padding.
+Returns:
+    n/a
+**************************************************************************/
+void writeResults(int iFormat, int iRun, Graph graph, PathList *pPaths)
+{
+    int iv;
+    VertexResult result;
+    char cCritical;
+    CriticalPathFn pfnPath;
+    if (iFormat == FORMAT_TEXT)
+    {
+        printGraph(iRun, "PERT TE and TL", graph);
+        if (pPaths == NULL)
+            printCriticalPaths(graph);
+        else
+        {
+            printf("Critical Path(s)\n");
+            if (forEachListedPath(graph, pPaths, printTextPath, NULL) != PERT_OK)
+                ErrExit(ERR_ALGORITHM, "number of sources returned is 0");
+        }
+        printf("\n");
+        return;
+    }
+    for (iv = 0; iv < graph->iNumVertices; iv++)
+    {
+        getVertexResult(graph, iv, &result);
+        switch (iFormat)
+        {
+            case FORMAT_CSV:
+                printf("V,%d,", iRun);
+                printCsvLabel(result.cLabel);
+                printf(",%" WEIGHT_OUT ",%" WEIGHT_OUT ",%" WEIGHT_OUT ",%d,\n"
+                    , result.iTE, result.iTL, result.iSlack, result.bCritical);
+                break;
+            case FORMAT_JSONL:
+                printf("{\"graph\":%d,\"vertex\":", iRun);
+                printJsonLabel(result.cLabel);
+                printf(",\"te\":%" WEIGHT_OUT ",\"tl\":%" WEIGHT_OUT ",\"slack\":%" WEIGHT_OUT
+                    ",\"critical\":%s}\n"
+                    , result.iTE, result.iTL, result.iSlack
+                    , result.bCritical ? "true" : "false");
+                break;
+            default:
+                cCritical = (char)result.bCritical;
+                fwrite("V", 1, 1, stdout);
+                fwrite(&iRun, sizeof(int), 1, stdout);
+                fwrite(&result.cLabel, 1, 1, stdout);
+                fwrite(&result.iTE, sizeof(Weight), 1, stdout);
+                fwrite(&result.iTL, sizeof(Weight), 1, stdout);
+                fwrite(&result.iSlack, sizeof(Weight), 1, stdout);
+                fwrite(&cCritical, 1, 1, stdout);
+        }
+    }
+    if (iFormat == FORMAT_CSV)
+        pfnPath = printCsvPath;
+    else if (iFormat == FORMAT_JSONL)
+        pfnPath = printJsonPath;
+    else
+        pfnPath = writeBinaryPath;
+    if (forEachListedPath(graph, pPaths, pfnPath, &iRun) != PERT_OK)
+        ErrExit(ERR_ALGORITHM, "number of sources returned is 0");
+}
+/******************** critical path writers **************************************
+   void printTextPath(char szPath[], int iLength, void *pState)
+   void printCsvPath(char szPath[], int iLength, void *pState)
+   void printJsonPath(char szPath[], int iLength, void *pState)
+   void writeBinaryPath(char szPath[], int iLength, void *pState)
+Purpose:
+    CriticalPathFn functions which write one critical path in each of the
+    output formats described in writeResults.
+Parameters:
+    I   char szPath[]           Labels of the vertices on the path.
+    I   int iLength             Number of labels in szPath.
+    I   void *pState            Pointer to the graph's iRun (not used by
+                                printTextPath).
+Returns:
+    n/a
+**************************************************************************/
+void printTextPath(char szPath[], int iLength, void *pState)
+{
+    int i;
+    (void)pState;
+    for (i = 0; i < iLength - 1; i++)
+        printf("%c ", szPath[i]);
+    printf("%c\n", szPath[iLength - 1]);
+}
+void printCsvPath(char szPath[], int iLength, void *pState)
+{
+    int i;
+    printf("P,%d,,,,,,", *(int *)pState);
+    // quote the path if a label would confuse a CSV reader
+    if (strpbrk(szPath, ",\"") != NULL)
+    {
+        printf("\"");
+        for (i = 0; i < iLength; i++)
+            printf(szPath[i] == '"' ? "\"\"" : "%c", szPath[i]);
+        printf("\"\n");
+    }
+    else
+        printf("%s\n", szPath);
+}
+void printJsonPath(char szPath[], int iLength, void *pState)
+{
+    int i;
+    printf("{\"graph\":%d,\"criticalPath\":[", *(int *)pState);
+    for (i = 0; i < iLength; i++)
+    {
+        if (i > 0)
+            printf(",");
+        printJsonLabel(szPath[i]);
+    }
+    printf("]}\n");
+}
+void writeBinaryPath(char szPath[], int iLength, void *pState)
+{
+    unsigned char ucLength = (unsigned char)iLength;
+    fwrite("P", 1, 1, stdout);
+    fwrite(pState, sizeof(int), 1, stdout);
+    fwrite(&ucLength, 1, 1, stdout);
+    fwrite(szPath, 1, iLength, stdout);
+}
+/******************** printCsvLabel / printJsonLabel **************************
+   void printCsvLabel(char cLabel)
+   void printJsonLabel(char cLabel)
+Purpose:
+    Prints a vertex label as a CSV field or as a JSON string, quoting
+    and escaping it as needed.
+Parameters:
+    I   char cLabel             The vertex's label.
+Notes:
+    A label can be any byte from the input.  JSON strings can't hold 
+    control characters and must be UTF-8, so bytes below 0x20 and from 
+    0x80 up are written as \u00XX (the byte's Latin-1 character).
+Returns:
+    n/a
+**************************************************************************/
+void printCsvLabel(char cLabel)
+{
+    if (cLabel == ',')
+        printf("\",\"");
+    else if (cLabel == '"')
+        printf("\"\"\"\"");
+    else
+        printf("%c", cLabel);
+}
+void printJsonLabel(char cLabel)
+{
+    unsigned char ucLabel = (unsigned char)cLabel;
+    if (cLabel == '"' || cLabel == '\\')
+        printf("\"\\%c\"", cLabel);
+    else if (ucLabel < 0x20 || ucLabel >= 0x80)
+        printf("\"\\u%04x\"", ucLabel);
+    else
+        printf("\"%c\"", cLabel);
+}
+/******************** printCrashStep **************************************
+   void printCrashStep(Weight makespan, Weight cost, struct Data crashedM[]
+       , int iNumCrashed, void *pState)
+Purpose:
+    CrashStepFn which prints one point of a crashing curve:  the makespan,
+    the total cost so far and each edge changed by the step.
+Parameters:
+    I   Weight makespan         Largest TE after the step.
+    I   Weight cost             Total cost of the steps so far.
+    I   struct Data crashedM[]  Edges changed by the step and their new
+                                path weights.
+    I   int iNumCrashed         Number of edges in crashedM.
+    I   void *pState            Not used.
+Returns:
+    n/a
+**************************************************************************/
+void printCrashStep(Weight makespan, Weight cost, struct Data crashedM[]
+    , int iNumCrashed, void *pState)
+{
+    int i;
+    (void)pState;
+    printf("   %" WEIGHT_PRT " %4" WEIGHT_OUT "\t", makespan, cost);
+    if (iNumCrashed == 0)
+        printf("-");
+    for (i = 0; i < iNumCrashed; i++)
+        printf("%c %c %" WEIGHT_PRT "  ", crashedM[i].cFrom, crashedM[i].cTo, crashedM[i].iPath);
+    printf("\n");
+}
+/******************** printScenarioResults **************************************
+   void printScenarioResults(int iRun, Graph graph, ScenarioResult resultM[]
+       , int iNumScenarios)
+Purpose:
+    Prints the makespan of each what-if scenario and the vertices that 
+    became or stopped being critical in it.
+Parameters:
+    I   int iRun                Graph number.
+    I   Graph graph             The graph the scenarios changed.
+    I   ScenarioResult resultM[]  Results from pertEvaluateScenarios.
+    I   int iNumScenarios       Number of scenarios.
+Notes:
+    Scenarios are numbered from 1 as in the scenario file.
+Returns:
+    n/a
+**************************************************************************/
+void printScenarioResults(int iRun, Graph graph, ScenarioResult resultM[]
+    , int iNumScenarios)
+{
+    int s;
+    int iNumPrinted;                    // labels printed in the first column
+    printf("Graph #%2d: What-if scenarios\n", iRun);
+    printf("%4s %5s\t%-28s%s\n", "Scen", "MaxTE", "NOW CRITICAL", "NO LONGER CRITICAL");
+    for (s = 0; s < iNumScenarios; s++)
+    {
+        printf("%4d   %" WEIGHT_PRT "\t", s + 1, resultM[s].maxTE);
+        printVertexMask(graph, resultM[s].nowCriticalM);
+        // line up the next column (each label or "-" takes 2 characters)
+        iNumPrinted = resultM[s].iNumNowCritical > 0 ? resultM[s].iNumNowCritical : 1;
+        printSpaces("  ", 14 - iNumPrinted);
+        printVertexMask(graph, resultM[s].noLongerCriticalM);
+        printf("\n");
+    }
+}
+/******************** printVertexMask **************************************
+   void printVertexMask(Graph graph, uint64_t maskM[])
+Purpose:
+    Prints the labels of the vertices in a vertex mask followed by a 
+    space, or "-" if the mask is empty.
+Parameters:
+    I   Graph graph             The graph the mask's bits refer to.
+    I   uint64_t maskM[]        VERTEX_MASK_WORDS words, one bit per vertex.
+Returns:
+    n/a
+**************************************************************************/
+void printVertexMask(Graph graph, uint64_t maskM[])
+{
+    int iv;
+    int bAny = FALSE;
+    for (iv = 0; iv < graph->iNumVertices; iv++)
+    {
+        if (maskM[iv / 64] & ((uint64_t)1 << (iv % 64)))
+        {
+            printf("%c ", graph->vertexM[iv].cLabel);
+            bAny = TRUE;
+        }
+    }
+    if (!bAny)
+        printf("- ");
+}
+/******************** setBinaryOutput **************************************
+   void setBinaryOutput()
+Purpose:
+    Makes certain stdout doesn't translate newline bytes in the binary 
+    output format.
+Notes:
+    - Only Windows translates them.
+Returns:
+    n/a
+**************************************************************************/
+void setBinaryOutput()
+{
+#ifdef _WIN32
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+#ifndef _WIN32
+/******************** runServer **************************************
+   int runServer(char *pszSocketPath)
+Purpose:
+    Serves PERT requests on a Unix domain socket, keeping up to 
+    MAX_CACHED_GRAPHS graphs (each in its own PertContext) in memory.
+Parameters:
+    I   char *pszSocketPath     Path of the socket.  An existing socket at
+                                that path is removed first; any other kind
+                                of file is left alone and the server fails.
+Notes:
+    - Up to MAX_CONNECTIONS connections are multiplexed with poll.  A 
+      connection may send any number of requests and gets one response 
+      for each.  Each connection's requests are assembled as their bytes
+      arrive (see readRequests), so an idle connection or one that has
+      only sent part of a request doesn't hold up the others.  Responses
+      are sent without blocking (see sendResponse); if a client stops
+      taking its response for SERVER_TIMEOUT seconds, the connection is 
+      closed.
+    - All integers and Weights are in native byte order (the client is on 
+      the same machine).  A request is:
+          char      op              one of the REQ_ constants
+          uint32_t  graph id
+          uint16_t  number of edges
+          edges     char from, char to, Weight path for each edge
+      REQ_LOAD replaces the graph with the edges (a repeated edge keeps
+      its first path weight).  REQ_UPDATE changes the 
+      path weights of existing edges.  REQ_ADD adds edges (an existing edge
+      gets the new weight).  REQ_REMOVE removes edges (path is ignored).
+      REQ_QUERY (no edges) returns the results.  REQ_DROP forgets the graph.
+    - A response is:
+          uint32_t  number of bytes that follow
+          int32_t   PERT_OK or an ERR_ constant
+      followed by, for an error:
+          uint16_t  message length and the message
+      or, for a successful REQ_QUERY:
+          uint16_t  number of vertices
+          vertices  char label, Weight te, Weight tl, Weight slack, 
+                    char critical for each vertex
+          uint32_t  number of critical paths
+          paths     uint8_t length and the labels for each path
+    - Results are cached.  REQ_UPDATE only changes the weights in place
+      and REQ_ADD/REQ_REMOVE only change the edge list; the graph is 
+      rebuilt and TE/TL recomputed when the next REQ_QUERY needs them.
+    - REQ_UPDATE, REQ_ADD and REQ_REMOVE check all of their edges first,
+      so a failing request changes nothing.
+    - When the cache is full, loading a new graph id replaces the least
+      recently used graph.
+Returns:
+    Only returns if the server can't be started:  ERR_ALGORITHM.
+**************************************************************************/
+int runServer(char *pszSocketPath)
+{
+    int fdListen;
+    int fd;
+    struct sockaddr_un addr;
+    struct stat st;
+    struct pollfd pollM[MAX_CONNECTIONS + 1];   // [0] is the listening socket
+    Connection *connM;                          // connM[i - 1] is pollM[i]'s
+    Connection *pConn;
+    int iNumPolled = 1;
+    int bSending;                   // TRUE if a connection has an unsent response
+    int bOpen;
+    int i;
+    time_t tNow;
+    CachedGraph *cacheM;
+    Response response;
+
+    cacheM = (CachedGraph *)calloc(MAX_CACHED_GRAPHS, sizeof(CachedGraph));
+    connM = (Connection *)malloc(MAX_CONNECTIONS * sizeof(Connection));
+    response.pszBuffer = (char *)malloc(SERVER_RESPONSE_SIZE);
+    if (cacheM == NULL || connM == NULL || response.pszBuffer == NULL)
+        return ERR_ALGORITHM;
+    if (strlen(pszSocketPath) >= sizeof(addr.sun_path))
+        return ERR_ALGORITHM;
+    signal(SIGPIPE, SIG_IGN);       // a client going away isn't fatal
+
+    fdListen = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fdListen < 0)
+        return ERR_ALGORITHM;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, pszSocketPath);
+    // only replace a socket left by an earlier server
+    if (lstat(pszSocketPath, &st) == 0)
+    {
+        if (!S_ISSOCK(st.st_mode))
+            return ERR_ALGORITHM;
+        unlink(pszSocketPath);
+    }
+    if (bind(fdListen, (struct sockaddr *)&addr, sizeof(addr)) != 0
+        || listen(fdListen, 16) != 0)
+        return ERR_ALGORITHM;
+
+    pollM[0].fd = fdListen;
+    for (;;)
+    {
+        // stop accepting while every connection slot is in use
+        pollM[0].events = iNumPolled <= MAX_CONNECTIONS ? POLLIN : 0;
+        // a connection's next request isn't read until its response is sent
+        bSending = FALSE;
+        for (i = 1; i < iNumPolled; i++)
+        {
+            pollM[i].events = connM[i - 1].pszOutput != NULL ? POLLOUT : POLLIN;
+            if (connM[i - 1].pszOutput != NULL)
+                bSending = TRUE;
+        }
+        // wake up once a second to time out clients that stopped reading
+        if (poll(pollM, iNumPolled, bSending ? 1000 : -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return ERR_ALGORITHM;
+        }
+        tNow = time(NULL);
+        for (i = iNumPolled - 1; i > 0; i--)
+        {
+            pConn = &connM[i - 1];
+            if ((pollM[i].revents & (POLLERR | POLLNVAL))
+                || (pConn->pszOutput != NULL && (pollM[i].revents & POLLHUP)))
+                bOpen = FALSE;
+            else if (pollM[i].revents & POLLOUT)
+                bOpen = flushResponse(pConn) && parseRequests(pConn, cacheM, &response);
+            else if (pollM[i].revents & (POLLIN | POLLHUP))
+                bOpen = readRequests(pConn, cacheM, &response);
+            else
+                bOpen = pConn->pszOutput == NULL || tNow - pConn->tLastOutput < SERVER_TIMEOUT;
+            if (!bOpen)
+            {   // closed, failed or timed out:  the last slot fills the hole
+                closeConnection(pConn);
+                iNumPolled--;
+                pollM[i] = pollM[iNumPolled];
+                connM[i - 1] = connM[iNumPolled - 1];
+            }
+        }
+        if (pollM[0].revents & POLLIN)
+        {
+            fd = accept(fdListen, NULL, NULL);
+            if (fd < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                return ERR_ALGORITHM;
+            }
+            // responses are sent as the client takes them (see sendResponse)
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            pollM[iNumPolled].fd = fd;
+            pollM[iNumPolled].revents = 0;
+            pConn = &connM[iNumPolled - 1];
+            pConn->fd = fd;
+            pConn->iOffset = 0;
+            pConn->iInputNext = 0;
+            pConn->iInputEnd = 0;
+            pConn->pszOutput = NULL;
+            iNumPolled++;
+        }
+    }
+}
+/******************** readRequests **************************************
+   int readRequests(Connection *pConn, CachedGraph cacheM[], Response *pResponse)
+Purpose:
+    Reads what a ready connection has sent and serves each request that 
+    is now complete.
+Parameters:
+    I/O Connection *pConn       The connection and its partial request.
+    I/O CachedGraph cacheM[]    The graphs kept by the server.
+    I/O Response *pResponse     Buffer for building a response.
+Notes:
+    - Only one read is done, so it doesn't wait for the rest of a 
+      request.  It is only called when the connection has no unsent
+      response, and so nothing read earlier is waiting to be parsed.
+Returns:
+    TRUE - the connection is still open.
+    FALSE - the connection was closed or failed, or a response couldn't
+            be sent.
+**************************************************************************/
+int readRequests(Connection *pConn, CachedGraph cacheM[], Response *pResponse)
+{
+    ssize_t iCount;
+    iCount = read(pConn->fd, pConn->szInput, sizeof(pConn->szInput));
+    if (iCount < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))
+        return TRUE;
+    if (iCount <= 0)
+        return FALSE;
+    pConn->iInputNext = 0;
+    pConn->iInputEnd = (int)iCount;
+    return parseRequests(pConn, cacheM, pResponse);
+}
+/******************** parseRequests **************************************
+   int parseRequests(Connection *pConn, CachedGraph cacheM[], Response *pResponse)
+Purpose:
+    Assembles requests from the bytes a connection has sent and serves 
+    each one that is complete.
+Parameters:
+    I/O Connection *pConn       The connection and its partial request.
+    I/O CachedGraph cacheM[]    The graphs kept by the server.
+    I/O Response *pResponse     Buffer for building a response.
+Notes:
+    - pConn->iOffset counts the bytes of the current request received so
+      far; the header and the edge being received are kept until they
+      are complete.
+    - It stops when a response couldn't be sent completely.  The rest of
+      the bytes stay in szInput until flushResponse has sent it, so a 
+      client that stops reading has at most one response queued.
+    - The edges after the first MAX_EDGES are read but dropped, and the
+      request gets an ERR_BAD_INPUT response.
+Returns:
+    TRUE - the connection is still open.
+    FALSE - a response couldn't be sent.
+**************************************************************************/
+int parseRequests(Connection *pConn, CachedGraph cacheM[], Response *pResponse)
+{
+    int iEdge;                      // edge being received
+    uint16_t usNumEdges;
+    while (pConn->iInputNext < pConn->iInputEnd && pConn->pszOutput == NULL)
+    {
+        if (pConn->iOffset < REQUEST_HEADER_SIZE)
+            pConn->szHeader[pConn->iOffset++] = pConn->szInput[pConn->iInputNext++];
+        else
+        {
+            iEdge = (pConn->iOffset - REQUEST_HEADER_SIZE) / REQUEST_EDGE_SIZE;
+            pConn->szEdge[(pConn->iOffset - REQUEST_HEADER_SIZE) % REQUEST_EDGE_SIZE] 
+                = pConn->szInput[pConn->iInputNext++];
+            pConn->iOffset++;
+            if ((pConn->iOffset - REQUEST_HEADER_SIZE) % REQUEST_EDGE_SIZE == 0
+                && iEdge < MAX_EDGES)
+            {
+                pConn->edgeM[iEdge].cFrom = pConn->szEdge[0];
+                pConn->edgeM[iEdge].cTo = pConn->szEdge[1];
+                memcpy(&pConn->edgeM[iEdge].iPath, &pConn->szEdge[2], sizeof(Weight));
+            }
+        }
+        if (pConn->iOffset < REQUEST_HEADER_SIZE)
+            continue;
+        memcpy(&usNumEdges, &pConn->szHeader[1 + sizeof(uint32_t)], sizeof(usNumEdges));
+        if (pConn->iOffset == REQUEST_HEADER_SIZE + usNumEdges * REQUEST_EDGE_SIZE)
+        {
+            pConn->iOffset = 0;
+            if (!serveRequest(pConn, cacheM, pResponse))
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
+/******************** serveRequest **************************************
+   int serveRequest(Connection *pConn, CachedGraph cacheM[], Response *pResponse)
+Purpose:
+    Carries out a connection's complete request and sends its response.
+Parameters:
+    I/O Connection *pConn       The connection with a complete request.
+    I/O CachedGraph cacheM[]    The graphs kept by the server.
+    I/O Response *pResponse     Buffer for building a response.
+Returns:
+    TRUE - the response was sent or queued (see sendResponse).
+    FALSE - it couldn't be (the connection failed).
+**************************************************************************/
+int serveRequest(Connection *pConn, CachedGraph cacheM[], Response *pResponse)
+{
+    char cOp = pConn->szHeader[0];
+    uint32_t uGraphId;
+    uint16_t usNumEdges;
+    uint32_t uLength;
+    memcpy(&uGraphId, &pConn->szHeader[1], sizeof(uGraphId));
+    memcpy(&usNumEdges, &pConn->szHeader[1 + sizeof(uint32_t)], sizeof(usNumEdges));
+    pResponse->iLength = sizeof(uint32_t);      // room for the length
+    pResponse->bOverflow = FALSE;
+    if (usNumEdges > MAX_EDGES)
+        appendError(pResponse, ERR_BAD_INPUT, "too many edges");
+    else
+    {
+        pConn->edgeM[usNumEdges].cFrom = '\0';
+        handleRequest(cacheM, cOp, uGraphId, pConn->edgeM, usNumEdges, pResponse);
+    }
+    uLength = (uint32_t)(pResponse->iLength - sizeof(uint32_t));
+    memcpy(pResponse->pszBuffer, &uLength, sizeof(uLength));
+    return sendResponse(pConn, pResponse);
+}
+/******************** handleRequest **************************************
+   void handleRequest(CachedGraph cacheM[], char cOp, uint32_t uGraphId
+        , struct Data edgeM[], int iNumEdges, Response *pResponse)
+Purpose:
+    Carries out one request and builds its response (after the length).
+Parameters:
+    I/O CachedGraph cacheM[]    The graphs kept by the server.
+    I   char cOp                The request (a REQ_ constant).
+    I   uint32_t uGraphId       Which graph.
+    I   struct Data edgeM[]     The request's edges.
+    I   int iNumEdges           Number of entries in edgeM.
+    I/O Response *pResponse     The response.
+Notes:
+    - REQ_LOAD keeps the first path weight of a repeated edge (as 
+      loadGraph does), so dataM has each edge once and REQ_UPDATE and 
+      REQ_REMOVE change every occurrence.
+    - A REQ_LOAD that fails doesn't keep a new entry, and an existing 
+      graph keeps its old edges.
+Returns:
+    n/a
+**************************************************************************/
+void handleRequest(CachedGraph cacheM[], char cOp, uint32_t uGraphId
+    , struct Data edgeM[], int iNumEdges, Response *pResponse)
+{
+    CachedGraph *pCached;
+    struct Data loadM[MAX_EDGES + 1];   // REQ_LOAD's edges without repeats
+    int iNumLoad = 0;
+    int bNew = FALSE;                   // TRUE if REQ_LOAD made the entry
+    int rc = PERT_OK;
+    int i;
+    int j;
+
+    pCached = findCachedGraph(cacheM, uGraphId, FALSE);
+    if (pCached == NULL && cOp == REQ_LOAD)
+    {
+        bNew = TRUE;
+        pCached = findCachedGraph(cacheM, uGraphId, TRUE);
+    }
+    if (pCached == NULL)
+    {
+        appendError(pResponse, ERR_BAD_INPUT, "graph not loaded");
+        return;
+    }
+    if ((cOp == REQ_UPDATE || cOp == REQ_ADD || cOp == REQ_REMOVE)
+        && checkCachedEdges(pCached, cOp, edgeM, iNumEdges) != PERT_OK)
+    {
+        appendError(pResponse, ERR_BAD_INPUT, "edge not found or too many edges");
+        return;
+    }
+    switch (cOp)
+    {
+        case REQ_LOAD:
+            for (i = 0; i < iNumEdges; i++)
+            {
+                for (j = 0; j < iNumLoad; j++)
+                {
+                    if (loadM[j].cFrom == edgeM[i].cFrom && loadM[j].cTo == edgeM[i].cTo)
+                        break;
+                }
+                if (j == iNumLoad)
+                    loadM[iNumLoad++] = edgeM[i];
+            }
+            loadM[iNumLoad].cFrom = '\0';
+            rc = pertBuild(pCached->ctx, loadM);
+            if (rc != PERT_OK)
+            {
+                appendError(pResponse, rc, pertErrorMessage(pCached->ctx));
+                if (bNew)
+                    pCached->bUsed = FALSE;     // its context is reused later
+                else
+                    pCached->bRebuild = TRUE;   // from the old dataM
+                return;
+            }
+            memcpy(pCached->dataM, loadM, sizeof(struct Data) * (iNumLoad + 1));
+            pCached->iNumData = iNumLoad;
+            pCached->bRebuild = FALSE;
+            break;
+        case REQ_UPDATE:
+            for (i = 0; i < iNumEdges && rc == PERT_OK; i++)
+            {
+                j = findCachedEdge(pCached, edgeM[i].cFrom, edgeM[i].cTo);
+                pCached->dataM[j].iPath = edgeM[i].iPath;
+                if (!pCached->bRebuild)
+                    rc = pertUpdatePath(pCached->ctx, edgeM[i].cFrom, edgeM[i].cTo, edgeM[i].iPath);
+            }
+            break;
+        case REQ_ADD:
+            for (i = 0; i < iNumEdges; i++)
+            {
+                j = findCachedEdge(pCached, edgeM[i].cFrom, edgeM[i].cTo);
+                if (j < 0)
+                {
+                    j = pCached->iNumData++;
+                    pCached->dataM[pCached->iNumData].cFrom = '\0';
+                }
+                pCached->dataM[j] = edgeM[i];
+            }
+            pCached->bRebuild = TRUE;
+            break;
+        case REQ_REMOVE:
+            for (i = 0; i < iNumEdges; i++)
+            {
+                j = findCachedEdge(pCached, edgeM[i].cFrom, edgeM[i].cTo);
+                pCached->iNumData--;
+                memmove(&pCached->dataM[j], &pCached->dataM[j + 1]
+                    , sizeof(struct Data) * (pCached->iNumData - j + 1));
+            }
+            pCached->bRebuild = TRUE;
+            break;
+        case REQ_QUERY:
+            rc = queryCachedGraph(pCached, pResponse);
+            if (rc != PERT_OK)
+            {
+                appendError(pResponse, rc, pertErrorMessage(pCached->ctx));
+                return;
+            }
+            if (pResponse->bOverflow)
+            {
+                pResponse->iLength = sizeof(uint32_t);
+                appendError(pResponse, ERR_ALGORITHM, "too many critical paths");
+            }
+            return;
+        case REQ_DROP:
+            freePertContext(pCached->ctx);
+            pCached->ctx = NULL;
+            pCached->bUsed = FALSE;
+            break;
+        default:
+            appendError(pResponse, ERR_BAD_INPUT, "unknown request");
+            return;
+    }
+    if (rc != PERT_OK)
+    {
+        appendError(pResponse, rc, "edge not found or too many edges");
+        return;
+    }
+    appendResponse(pResponse, &rc, sizeof(int32_t));
+}
+/******************** queryCachedGraph **************************************
+   int queryCachedGraph(CachedGraph *pCached, Response *pResponse)
+Purpose:
+    Appends a graph's vertex results and critical paths to a response,
+    rebuilding and computing the graph first if needed.
+Parameters:
+    I/O CachedGraph *pCached    The graph.
+    I/O Response *pResponse     The response.
+Returns:
+    PERT_OK - the results were appended.
+    else    - the ERR_ constant from building or computing the graph.
+**************************************************************************/
+int queryCachedGraph(CachedGraph *pCached, Response *pResponse)
+{
+    int rc = PERT_OK;
+    int iNumVertices;
+    int v;
+    uint16_t usNumVertices;
+    uint32_t uNumPaths = 0;
+    int iPathCountAt;               // where the number of paths goes
+    VertexResult resultM[MAX_VERTICES];
+    char cCritical;
+
+    if (pCached->bRebuild)
+    {
+        rc = pertBuild(pCached->ctx, pCached->dataM);
+        if (rc != PERT_OK)
+            return rc;
+        pCached->bRebuild = FALSE;
+    }
+    if (!pCached->ctx->bComputed)
+    {
+        rc = pertCompute(pCached->ctx);
+        if (rc != PERT_OK)
+            return rc;
+    }
+    pertExportVertices(pCached->ctx, resultM, &iNumVertices);
+    appendResponse(pResponse, &rc, sizeof(int32_t));
+    usNumVertices = (uint16_t)iNumVertices;
+    appendResponse(pResponse, &usNumVertices, sizeof(usNumVertices));
+    for (v = 0; v < iNumVertices; v++)
+    {
+        cCritical = (char)resultM[v].bCritical;
+        appendResponse(pResponse, &resultM[v].cLabel, 1);
+        appendResponse(pResponse, &resultM[v].iTE, sizeof(Weight));
+        appendResponse(pResponse, &resultM[v].iTL, sizeof(Weight));
+        appendResponse(pResponse, &resultM[v].iSlack, sizeof(Weight));
+        appendResponse(pResponse, &cCritical, 1);
+    }
+    iPathCountAt = pResponse->iLength;
+    appendResponse(pResponse, &uNumPaths, sizeof(uNumPaths));
+    if (iNumVertices > 0)
+        forEachCriticalPath(pertGraph(pCached->ctx), appendResponsePath, pResponse);
+    if (!pResponse->bOverflow)
+    {   // count the paths that were appended
+        uNumPaths = countResponsePaths(pResponse, iPathCountAt + sizeof(uNumPaths));
+        memcpy(&pResponse->pszBuffer[iPathCountAt], &uNumPaths, sizeof(uNumPaths));
+    }
+    return PERT_OK;
+}
+/******************** findCachedGraph **************************************
+   CachedGraph *findCachedGraph(CachedGraph cacheM[], uint32_t uGraphId, int bCreate)
+Purpose:
+    Finds a graph kept by the server, optionally making room for it.
+Parameters:
+    I/O CachedGraph cacheM[]    The graphs kept by the server.
+    I   uint32_t uGraphId       Which graph.
+    I   int bCreate             TRUE - if it isn't there, use an empty 
+                                entry or replace the least recently used.
+Notes:
+    - Each call counts as a use of the graph it returns.
+Returns:
+    The graph's entry or NULL if it isn't there (or can't be allocated).
+**************************************************************************/
+CachedGraph *findCachedGraph(CachedGraph cacheM[], uint32_t uGraphId, int bCreate)
+{
+    static unsigned long ulClock = 0;   // counts uses for least recently used
+    CachedGraph *pFree = NULL;
+    CachedGraph *pOldest = NULL;
+    int i;
+    ulClock++;
+    for (i = 0; i < MAX_CACHED_GRAPHS; i++)
+    {
+        if (!cacheM[i].bUsed)
+        {
+            if (pFree == NULL)
+                pFree = &cacheM[i];
+            continue;
+        }
+        if (cacheM[i].uGraphId == uGraphId)
+        {
+            cacheM[i].ulLastUse = ulClock;
+            return &cacheM[i];
+        }
+        if (pOldest == NULL || cacheM[i].ulLastUse < pOldest->ulLastUse)
+            pOldest = &cacheM[i];
+    }
+    if (!bCreate)
+        return NULL;
+    if (pFree == NULL)
+        pFree = pOldest;            // evict it, but reuse its context
+    if (pFree->ctx == NULL)
+    {
+        pFree->ctx = newPertContext();
+        if (pFree->ctx == NULL)
+            return NULL;
+    }
+    pFree->bUsed = TRUE;
+    pFree->uGraphId = uGraphId;
+    pFree->ulLastUse = ulClock;
+    pFree->iNumData = 0;
+    pFree->dataM[0].cFrom = '\0';
+    pFree->bRebuild = TRUE;
+    return pFree;
+}
+/******************** findCachedEdge **************************************
+   int findCachedEdge(CachedGraph *pCached, char cFrom, char cTo)
+Purpose:
+    Finds an edge in a cached graph's edge list.
+Parameters:
+    I   CachedGraph *pCached    The graph.
+    I   char cFrom              Label of the FROM vertex.
+    I   char cTo                Label of the TO vertex.
+Returns:
+    >= 0 - subscript in pCached->dataM
+    -1 - not found
+**************************************************************************/
+int findCachedEdge(CachedGraph *pCached, char cFrom, char cTo)
+{
+    int i;
+    for (i = 0; i < pCached->iNumData; i++)
+    {
+        if (pCached->dataM[i].cFrom == cFrom && pCached->dataM[i].cTo == cTo)
+            return i;
+    }
+    return -1;
+}
+/******************** checkCachedEdges **************************************
+   int checkCachedEdges(CachedGraph *pCached, char cOp, struct Data edgeM[]
+        , int iNumEdges)
+Purpose:
+    Checks that a REQ_UPDATE, REQ_ADD or REQ_REMOVE can be done for all 
+    of its edges before any of them are changed.
+Parameters:
+    I   CachedGraph *pCached    The graph.
+    I   char cOp                The request.
+    I   struct Data edgeM[]     The request's edges.
+    I   int iNumEdges           Number of entries in edgeM.
+Notes:
+    - An edge repeated in a REQ_REMOVE would be gone by its second 
+      occurrence, so it fails.  Repeats in a REQ_ADD only count once
+      toward MAX_EDGES.
+Returns:
+    PERT_OK - every edge can be changed.
+    ERR_BAD_INPUT - an edge isn't in the graph (REQ_UPDATE, REQ_REMOVE)
+                    or the graph would have too many edges (REQ_ADD).
+**************************************************************************/
+int checkCachedEdges(CachedGraph *pCached, char cOp, struct Data edgeM[], int iNumEdges)
+{
+    int iNumNew = 0;                // edges REQ_ADD would append
+    int bRepeat;
+    int i;
+    int k;
+    for (i = 0; i < iNumEdges; i++)
+    {
+        bRepeat = FALSE;
+        for (k = 0; k < i && !bRepeat; k++)
+            bRepeat = edgeM[k].cFrom == edgeM[i].cFrom && edgeM[k].cTo == edgeM[i].cTo;
+        if (findCachedEdge(pCached, edgeM[i].cFrom, edgeM[i].cTo) >= 0)
+        {
+            if (cOp == REQ_REMOVE && bRepeat)
+                return ERR_BAD_INPUT;
+        }
+        else if (cOp != REQ_ADD)
+            return ERR_BAD_INPUT;
+        else if (!bRepeat)
+            iNumNew++;
+    }
+    if (pCached->iNumData + iNumNew > MAX_EDGES)
+        return ERR_BAD_INPUT;
+    return PERT_OK;
+}
+/******************** response building **************************************
+   void appendResponse(Response *pResponse, void *pData, int iLength)
+   void appendError(Response *pResponse, int rc, char *pszMessage)
+   void appendResponsePath(char szPath[], int iLength, void *pState)
+   uint32_t countResponsePaths(Response *pResponse, int iFrom)
+Purpose:
+    appendResponse appends bytes to a response.  If they don't fit, 
+    bOverflow is set and they are dropped.
+    appendError appends an error's return code and message.
+    appendResponsePath is a CriticalPathFn that appends a path (pState is
+    the Response).
+    countResponsePaths counts the paths appended after iFrom.
+**************************************************************************/
+void appendResponse(Response *pResponse, void *pData, int iLength)
+{
+    if (pResponse->iLength + iLength > SERVER_RESPONSE_SIZE)
+    {
+        pResponse->bOverflow = TRUE;
+        return;
+    }
+    memcpy(&pResponse->pszBuffer[pResponse->iLength], pData, iLength);
+    pResponse->iLength += iLength;
+}
+void appendError(Response *pResponse, int rc, char *pszMessage)
+{
+    uint16_t usLength = (uint16_t)strlen(pszMessage);
+    int32_t iRc = rc;
+    appendResponse(pResponse, &iRc, sizeof(iRc));
+    appendResponse(pResponse, &usLength, sizeof(usLength));
+    appendResponse(pResponse, pszMessage, usLength);
+}
+void appendResponsePath(char szPath[], int iLength, void *pState)
+{
+    unsigned char ucLength = (unsigned char)iLength;
+    appendResponse((Response *)pState, &ucLength, 1);
+    appendResponse((Response *)pState, szPath, iLength);
+}
+uint32_t countResponsePaths(Response *pResponse, int iFrom)
+{
+    uint32_t uNumPaths = 0;
+    int i;
+    for (i = iFrom; i < pResponse->iLength; i += 1 + (unsigned char)pResponse->pszBuffer[i])
+        uNumPaths++;
+    return uNumPaths;
+}
+/******************** sendResponse **************************************
+   int sendResponse(Connection *pConn, Response *pResponse)
+Purpose:
+    Sends a response without waiting for the client to take it.
+Parameters:
+    I/O Connection *pConn       The connection (non-blocking).
+    I   Response *pResponse     The response.
+Notes:
+    - Whatever the socket doesn't take now is copied to pConn->pszOutput
+      and sent by flushResponse when poll says the socket can take more.
+      Until then the connection's next request isn't parsed, so a client
+      that stops reading only holds up itself.
+Returns:
+    TRUE - the response was sent or queued.
+    FALSE - the connection failed or the queue couldn't be allocated.
+**************************************************************************/
+int sendResponse(Connection *pConn, Response *pResponse)
+{
+    int iSent;
+    iSent = writeAvailable(pConn->fd, pResponse->pszBuffer, pResponse->iLength);
+    if (iSent < 0)
+        return FALSE;
+    if (iSent == pResponse->iLength)
+        return TRUE;
+    pConn->iOutputEnd = pResponse->iLength - iSent;
+    pConn->pszOutput = (char *)malloc(pConn->iOutputEnd);
+    if (pConn->pszOutput == NULL)
+        return FALSE;
+    memcpy(pConn->pszOutput, &pResponse->pszBuffer[iSent], pConn->iOutputEnd);
+    pConn->iOutputNext = 0;
+    pConn->tLastOutput = time(NULL);
+    return TRUE;
+}
+/******************** flushResponse **************************************
+   int flushResponse(Connection *pConn)
+Purpose:
+    Sends more of a connection's queued response.
+Parameters:
+    I/O Connection *pConn       The connection with a queued response.
+Notes:
+    - tLastOutput is updated when bytes are sent; runServer closes a 
+      connection whose response hasn't moved for SERVER_TIMEOUT seconds.
+    - The queue is freed once all of it is sent.
+Returns:
+    TRUE - the connection is still open.
+    FALSE - it failed.
+**************************************************************************/
+int flushResponse(Connection *pConn)
+{
+    int iSent;
+    iSent = writeAvailable(pConn->fd, &pConn->pszOutput[pConn->iOutputNext]
+        , pConn->iOutputEnd - pConn->iOutputNext);
+    if (iSent < 0)
+        return FALSE;
+    if (iSent > 0)
+        pConn->tLastOutput = time(NULL);
+    pConn->iOutputNext += iSent;
+    if (pConn->iOutputNext == pConn->iOutputEnd)
+    {
+        free(pConn->pszOutput);
+        pConn->pszOutput = NULL;
+    }
+    return TRUE;
+}
+/******************** writeAvailable **************************************
+   int writeAvailable(int fd, char *pData, int iLength)
+Purpose:
+    Writes as many of iLength bytes as a non-blocking socket takes, 
+    retrying short transfers and interrupted calls.
+Returns:
+    >= 0 - number of bytes written (less than iLength if the socket is
+           full)
+    -1 - the connection was closed or failed
+**************************************************************************/
+int writeAvailable(int fd, char *pData, int iLength)
+{
+    int iSent = 0;
+    ssize_t iCount;
+    while (iSent < iLength)
+    {
+        iCount = write(fd, &pData[iSent], iLength - iSent);
+        if (iCount < 0 && errno == EINTR)
+            continue;
+        if (iCount < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (iCount <= 0)
+            return -1;
+        iSent += (int)iCount;
+    }
+    return iSent;
+}
+/******************** closeConnection **************************************
+   void closeConnection(Connection *pConn)
+Purpose:
+    Closes a connection and frees its queued response.
+Parameters:
+    I/O Connection *pConn       The connection.
+Returns:
+    n/a
+**************************************************************************/
+void closeConnection(Connection *pConn)
+{
+    close(pConn->fd);
+    free(pConn->pszOutput);
+    pConn->pszOutput = NULL;
+}
+#else
+int runServer(char *pszSocketPath)
+{
+    return ERR_COMMAND_LINE;
+}
+#endif
+
+#ifndef _WIN32
+/******************** openResultCache **************************************
+   int openResultCache(char *pszPath, int iNumEntries, ResultCache *pCache)
+Purpose:
+    Opens (creating it if needed) a file of computed graphs and maps it 
+    into memory.
+Parameters:
+    I   char *pszPath           The cache file.
+    I   int iNumEntries         Number of graphs a new file can hold.  An
+                                existing file keeps its size.
+    O   ResultCache *pCache     The open cache.
+Notes:
+    - The file is a CacheHeader followed by its CacheEntry array.  Each
+      entry has a graph's canonical edge list (see canonicalEdges), 
+      its vertices' TE and distance from the sinks and its critical paths.
+    - A file made by a program using another Weight type is rejected.
+    - The file is locked with flock while it is created or checked and 
+      while lookupResultCache and storeResultCache use it, so runs can 
+      share it.
+Returns:
+    PERT_OK - the cache is open.
+    ERR_BAD_INPUT - the file isn't a cache file for this Weight type.
+    ERR_ALGORITHM - the file can't be opened, sized or mapped.
+**************************************************************************/
+int openResultCache(char *pszPath, int iNumEntries, ResultCache *pCache)
+{
+    struct stat st;
+    CacheHeader *pHeader;
+    int bNew;
+    int rc = PERT_OK;
+    pCache->fd = open(pszPath, O_RDWR | O_CREAT, 0644);
+    if (pCache->fd < 0)
+        return ERR_ALGORITHM;
+    // another run could be creating the same file
+    flock(pCache->fd, LOCK_EX);
+    if (fstat(pCache->fd, &st) != 0)
+        rc = ERR_ALGORITHM;
+    else if ((bNew = st.st_size == 0))
+    {
+        pCache->size = sizeof(CacheHeader) + (size_t)iNumEntries * sizeof(CacheEntry);
+        if (ftruncate(pCache->fd, (off_t)pCache->size) != 0)
+            rc = ERR_ALGORITHM;
+    }
+    else
+    {
+        pCache->size = (size_t)st.st_size;
+        if (pCache->size < sizeof(CacheHeader))
+            rc = ERR_BAD_INPUT;
+    }
+    if (rc != PERT_OK)
+    {
+        close(pCache->fd);
+        return rc;
+    }
+    pHeader = (CacheHeader *)mmap(NULL, pCache->size, PROT_READ | PROT_WRITE
+        , MAP_SHARED, pCache->fd, 0);
+    if (pHeader == (CacheHeader *)MAP_FAILED)
+    {
+        close(pCache->fd);
+        return ERR_ALGORITHM;
+    }
+    pCache->pHeader = pHeader;
+    pCache->entryM = (CacheEntry *)(pHeader + 1);
+    if (bNew)
+    {   // ftruncate filled it with zeros, so every entry is empty
+        memcpy(pHeader->szMagic, CACHE_MAGIC, sizeof(pHeader->szMagic));
+        pHeader->cWeightKind = WEIGHT_KIND;
+        pHeader->uEntrySize = sizeof(CacheEntry);
+        pHeader->uNumEntries = (uint32_t)iNumEntries;
+        pHeader->ullClock = 0;
+    }
+    else if (memcmp(pHeader->szMagic, CACHE_MAGIC, sizeof(pHeader->szMagic)) != 0
+        || pHeader->cWeightKind != WEIGHT_KIND
+        || pHeader->uEntrySize != sizeof(CacheEntry)
+        || sizeof(CacheHeader) + (size_t)pHeader->uNumEntries * sizeof(CacheEntry) > pCache->size)
+    {
+        closeResultCache(pCache);
+        return ERR_BAD_INPUT;
+    }
+    flock(pCache->fd, LOCK_UN);
+    return PERT_OK;
+}
+/******************** closeResultCache **************************************
+   void closeResultCache(ResultCache *pCache)
+Purpose:
+    Unmaps and closes a cache file.
+Parameters:
+    I/O ResultCache *pCache     The open cache.
+Returns:
+    n/a
+**************************************************************************/
+void closeResultCache(ResultCache *pCache)
+{
+    munmap(pCache->pHeader, pCache->size);
+    close(pCache->fd);
+}
+/******************** lookupResultCache **************************************
+   int lookupResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths)
+Purpose:
+    Looks for the context's graph in the cache and, if found, sets its TE
+    and TL and returns its critical paths from the cache instead of 
+    computing them.
+Parameters:
+    I/O ResultCache *pCache     The open cache.
+    I/O PertContext ctx         Context with a built graph.
+    O   PathList *pPaths        The graph's critical paths (see 
+                                forEachListedPath).
+Notes:
+    - Only entries with the same ullEdgeHash have their edge lists
+      compared with the graph's canonical edges, so a miss costs a scan of
+      the hashes.  A hit only needs the labels to find each vertex, so the
+      graph's vertices can be in any order.  An entry with a label that
+      isn't in the graph (a damaged file) is a miss.
+    - The file is locked with flock while it is searched, so another run
+      can't be storing into the entry being read.
+Returns:
+    TRUE - found; TE, TL and pPaths are set (the context is computed).
+    FALSE - not found.
+**************************************************************************/
+int lookupResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths)
+{
+    struct Data edgeM[MAX_EDGES];
+    int iNumEdges = -1;             // canonical edges not made yet
+    int iVertexM[MAX_VERTICES];     // graph vertex for each entry vertex
+    CacheEntry *pEntry;
+    Graph g = &ctx->graph;
+    Weight maxTE = WEIGHT_MIN;
+    int bFound = FALSE;
+    uint32_t u;
+    int i;
+    int v;
+    flock(pCache->fd, LOCK_EX);
+    for (u = 0; u < pCache->pHeader->uNumEntries && !bFound; u++)
+    {
+        pEntry = &pCache->entryM[u];
+        if (!pEntry->bUsed || pEntry->ullHash != g->ullEdgeHash
+            || pEntry->iNumVertices != g->iNumVertices || pEntry->iNumEdges != g->iNumEdges)
+            continue;
+        if (iNumEdges < 0)
+            iNumEdges = canonicalEdges(g, edgeM);
+        if (memcmp(pEntry->edgeM, edgeM, sizeof(struct Data) * iNumEdges) != 0)
+            continue;
+        // a damaged entry could name a label the graph doesn't have
+        for (i = 0; i < pEntry->iNumVertices; i++)
+        {
+            iVertexM[i] = ctx->iLabelM[(unsigned char)pEntry->cLabelM[i]];
+            if (iVertexM[i] < 0)
+                break;
+            if (pEntry->teM[i] > maxTE)
+                maxTE = pEntry->teM[i];
+        }
+        if (i < pEntry->iNumVertices)
+            continue;
+        // found it
+        for (i = 0; i < pEntry->iNumVertices; i++)
+        {
+            v = iVertexM[i];
+            g->vertexM[v].iMaxFromSource = pEntry->teM[i];
+            g->vertexM[v].iMaxFromSink = pEntry->sinkM[i];
+            g->vertexM[v].iTL = maxTE - pEntry->sinkM[i];
+        }
+        // a damaged length just means the paths are found again
+        pPaths->iLength = pEntry->paths.iLength;
+        if (pPaths->iLength > PATH_LIST_SIZE)
+            pPaths->iLength = -1;
+        if (pPaths->iLength > 0)
+            memcpy(pPaths->szListM, pEntry->paths.szListM, pPaths->iLength);
+        pEntry->ullLastUse = ++pCache->pHeader->ullClock;
+        ctx->bComputed = TRUE;
+        bFound = TRUE;
+    }
+    flock(pCache->fd, LOCK_UN);
+    return bFound;
+}
+/******************** storeResultCache **************************************
+   void storeResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths)
+Purpose:
+    Saves the context's computed graph and its critical paths in the 
+    cache, replacing an empty entry or else the least recently used one.
+Parameters:
+    I/O ResultCache *pCache     The open cache.
+    I   PertContext ctx         Context with TE and TL computed.
+    I   PathList *pPaths        Its critical paths (see listCriticalPaths).
+Returns:
+    n/a
+**************************************************************************/
+void storeResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths)
+{
+    CacheEntry *pEntry = NULL;
+    Graph g = &ctx->graph;
+    uint32_t u;
+    int v;
+    flock(pCache->fd, LOCK_EX);
+    for (u = 0; u < pCache->pHeader->uNumEntries; u++)
+    {
+        if (!pCache->entryM[u].bUsed)
+        {
+            pEntry = &pCache->entryM[u];
+            break;
+        }
+        if (pEntry == NULL || pCache->entryM[u].ullLastUse < pEntry->ullLastUse)
+            pEntry = &pCache->entryM[u];
+    }
+    if (pEntry == NULL)
+    {
+        flock(pCache->fd, LOCK_UN);
+        return;
+    }
+    pEntry->bUsed = FALSE;          // in case we're interrupted while copying
+    pEntry->ullHash = g->ullEdgeHash;
+    pEntry->iNumVertices = g->iNumVertices;
+    pEntry->iNumEdges = g->iNumEdges;
+    memset(pEntry->edgeM, '\0', sizeof(pEntry->edgeM));
+    canonicalEdges(g, pEntry->edgeM);
+    for (v = 0; v < g->iNumVertices; v++)
+    {
+        pEntry->cLabelM[v] = g->vertexM[v].cLabel;
+        pEntry->teM[v] = g->vertexM[v].iMaxFromSource;
+        pEntry->sinkM[v] = g->vertexM[v].iMaxFromSink;
+    }
+    memset(&pEntry->paths, '\0', sizeof(pEntry->paths));
+    pEntry->paths.iLength = pPaths->iLength;
+    if (pPaths->iLength > 0)
+        memcpy(pEntry->paths.szListM, pPaths->szListM, pPaths->iLength);
+    pEntry->ullLastUse = ++pCache->pHeader->ullClock;
+    pEntry->bUsed = TRUE;
+    flock(pCache->fd, LOCK_UN);
+}
+#else
+int openResultCache(char *pszPath, int iNumEntries, ResultCache *pCache)
+{
+    return ERR_COMMAND_LINE;
+}
+void closeResultCache(ResultCache *pCache)
+{
+}
+int lookupResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths)
+{
+    return FALSE;
+}
+void storeResultCache(ResultCache *pCache, PertContext ctx, PathList *pPaths)
+{
+}
+#endif
+/******************** canonicalEdges **************************************
+   int canonicalEdges(Graph g, struct Data edgeM[])
+Purpose:
+    Lists a graph's edges in an order that doesn't depend on the order of
+    the input.
+Parameters:
+    I   Graph g                 The graph.
+    O   struct Data edgeM[]     Its edges sorted by FROM label and then 
+                                TO label (not terminated).
+Notes:
+    - Every byte of the entries is set (including any padding) so two 
+      lists can be compared with memcmp.
+Returns:
+    number of edges.
+**************************************************************************/
+int canonicalEdges(Graph g, struct Data edgeM[])
+{
+    int iNumEdges = 0;
+    int v;
+    EdgeNode *e;
+    for (v = 0; v < g->iNumVertices; v++)
+    {
+        for (e = g->vertexM[v].successorList; e != NULL; e = e->pNextEdge)
+        {
+            memset(&edgeM[iNumEdges], '\0', sizeof(struct Data));
+            edgeM[iNumEdges].cFrom = g->vertexM[v].cLabel;
+            edgeM[iNumEdges].cTo = g->vertexM[e->edge.iVertex].cLabel;
+            edgeM[iNumEdges].iPath = e->edge.iPath;
+            iNumEdges++;
+        }
+    }
+    qsort(edgeM, iNumEdges, sizeof(struct Data), compareEdgeLabels);
+    return iNumEdges;
+}
+/******************** compareEdgeLabels **************************************
+   int compareEdgeLabels(const void *p1, const void *p2)
+Purpose:
+    qsort comparison of two struct Data by FROM label and then TO label.
+Returns:
+    < 0, 0, > 0 like strcmp
+**************************************************************************/
+int compareEdgeLabels(const void *p1, const void *p2)
+{
+    const struct Data *pData1 = (const struct Data *)p1;
+    const struct Data *pData2 = (const struct Data *)p2;
+    if (pData1->cFrom != pData2->cFrom)
+        return (unsigned char)pData1->cFrom - (unsigned char)pData2->cFrom;
+    return (unsigned char)pData1->cTo - (unsigned char)pData2->cTo;
+}
+/******************** listCriticalPaths **************************************
+   void listCriticalPaths(Graph g, PathList *pPaths)
+Purpose:
+    Saves a computed graph's critical paths so they can be kept in the 
+    result cache and written without searching the graph again.
+Parameters:
+    I   Graph g                 A graph with TE and TL computed.
+    O   PathList *pPaths        Its critical paths.
+Notes:
+    - If the paths don't fit (or the graph has no source), iLength is -1 
+      and forEachListedPath searches the graph instead.
+Returns:
+    n/a
+**************************************************************************/
+void listCriticalPaths(Graph g, PathList *pPaths)
+{
+    pPaths->iLength = 0;
+    if (forEachCriticalPath(g, appendListPath, pPaths) != PERT_OK)
+        pPaths->iLength = -1;
+}
+/******************** appendListPath **************************************
+   void appendListPath(char szPath[], int iLength, void *pState)
+Purpose:
+    CriticalPathFn for listCriticalPaths which appends a path to the 
+    PathList pState.
+Returns:
+    n/a
+**************************************************************************/
+void appendListPath(char szPath[], int iLength, void *pState)
+{
+    PathList *pPaths = (PathList *)pState;
+    if (pPaths->iLength < 0)
+        return;
+    if (pPaths->iLength + 1 + iLength > PATH_LIST_SIZE)
+    {
+        pPaths->iLength = -1;
+        return;
+    }
+    pPaths->szListM[pPaths->iLength++] = (char)iLength;
+    memcpy(&pPaths->szListM[pPaths->iLength], szPath, iLength);
+    pPaths->iLength += iLength;
+}
+/******************** forEachListedPath **************************************
+   int forEachListedPath(Graph g, PathList *pPaths, CriticalPathFn pfnPath
+       , void *pState)
+Purpose:
+    Calls a function with each critical path of a graph, using the paths 
+    saved by listCriticalPaths when there are some.
+Parameters:
+    I   Graph g                 A graph with TE and TL computed.
+    I   PathList *pPaths        Its saved paths, or NULL to search the graph.
+    I   CriticalPathFn pfnPath  Function called with each critical path.
+    I   void *pState            Passed to pfnPath.
+Notes:
+    - With a NULL pPaths or one whose paths didn't fit this is 
+      forEachCriticalPath.
+Returns:
+    PERT_OK - the paths were found.
+    ERR_ALGORITHM - the graph doesn't have a source.
+**************************************************************************/
+int forEachListedPath(Graph g, PathList *pPaths, CriticalPathFn pfnPath, void *pState)
+{
+    char szCriticalPath[MAX_VERTICES + 1];
+    int iLength;
+    int i = 0;
+    if (pPaths == NULL || pPaths->iLength < 0)
+        return forEachCriticalPath(g, pfnPath, pState);
+    while (i < pPaths->iLength)
+    {
+        iLength = (unsigned char)pPaths->szListM[i++];
+        if (iLength > MAX_VERTICES || i + iLength > pPaths->iLength)
+            break;
+        memcpy(szCriticalPath, &pPaths->szListM[i], iLength);
+        szCriticalPath[iLength] = '\0';
+        pfnPath(szCriticalPath, iLength, pState);
+        i += iLength;
+    }
+    return PERT_OK;
+}
+#ifndef _WIN32
+/******************** runOutOfCore **************************************
+   int runOutOfCore(char *pszResultPath, int iMemoryMB, char szMessage[])
+Purpose:
+    Computes TE, TL and slack for one graph read from stdin that can be
+    much larger than memory, keeping the edges and vertices in temporary
+    files.
 Parameters:
-    I   int iRun                Identifies which graph is being displayed. 
-    I   char *pszSubject        A message to display about this graph.
-    I   Graph graph             A directed graph represented by a double
-                                adjacency list.  
+    I   char *pszResultPath     File for the results (replaced if it
+                                exists).
+    I   int iMemoryMB           Megabytes of memory the run can use.
+    O   char szMessage[]        Why the run failed (OOC_MESSAGE_SIZE bytes).
 Notes:
-    - Since predecessors and successors are printed on the same line,
-      it uses the function printSpaces to help have all the lists of
-      predecessors appear in the same column.
+    - Each line of stdin is an edge "from to weight" where from and to are
+      vertex ids from 0 to OOC_MAX_ID.  The vertices are 0 through the
+      largest id, so an id without edges is a vertex by itself.  A repeated
+      edge counts once for each time it is listed (so its largest weight
+      decides TE).
+    - The steps are:
+        readOocEdges        copies the edges to a temporary file
+        sortOocFile         sorts them by FROM vertex and by TO vertex
+        makeOocVertices     counts each vertex's predecessors
+        levelOocVertices    places each vertex in a topological level
+        sortOocFile         sorts the edges by their FROM vertex's level
+        forwardOocPass      computes TE a level at a time
+        backwardOocPass     computes the distance to the sinks the same way
+        writeOocResults     writes the result file
+      The vertices are only read and written one record at a time from a
+      file, so memory holds the edges and updates of the current level
+      rather than the graph.
+    - The memory is one block of iMemoryMB megabytes: a quarter of it maps
+      the result file and the rest is used by each step in turn.  The
+      temporary files are in $TMPDIR (or /tmp) and are removed when the run
+      ends.
+    - The result file is an OocHeader followed by an OocResult for each
+      vertex id, in native byte order.
+    - Prints a one line summary to stdout.
 Returns:
-    n/a
+    PERT_OK - the result file was written.
+    ERR_BAD_INPUT - an edge couldn't be read, there are no edges or the
+                    graph has a cycle.
+    ERR_ALGORITHM - the memory couldn't be allocated or a file couldn't be
+                    used.
 **************************************************************************/
-void printGraph(int iRun, char *pszSubject, Graph graph)
+int runOutOfCore(char *pszResultPath, int iMemoryMB, char szMessage[])
 {
-    int iv;
-    EdgeNode *e;
-    int iCnt;
-    // Print headings
-    printf("Graph #%2d: %s\n", iRun, pszSubject);
-    printf("%3s %2s %2s\t%-24s    %-24s\n"
-        , "Vtx", "TE", "TL", "SUCCESSORS", "PREDECESSORS");
-    // for each vertex in the graph
-    for (iv = 0; iv < graph->iNumVertices; iv++)
+    OocRun run;
+    size_t budget = (size_t)iMemoryMB << 20;
+    size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+    uint64_t ullNumSources;
+    int fdInput = -1;               // edges as read
+    int fdByTo = -1;                // edges sorted by TO vertex
+    int fdQueue = -1;               // vertex ids in level order
+    int fdUnsorted = -1;            // OocLevelEdge in the order found
+    int rc = PERT_OK;
+    memset(&run, '\0', sizeof(run));
+    run.fdEdge = run.fdFirst = run.fdVertex = run.fdLevel = -1;
+    run.windowSize = budget / 4 / pageSize * pageSize;
+    run.size = budget - run.windowSize;
+    run.pArena = (char *)malloc(run.size);
+    if (run.pArena == NULL)
     {
-        // print the vertex label, TE, and TL
-        printf("%c   %2d %2d\t", graph->vertexM[iv].cLabel
-            , graph->vertexM[iv].iMaxFromSource
-            , graph->vertexM[iv].iTL);
-        iCnt = 0;
-        // print each of its successors
-        for (e = graph->vertexM[iv].successorList; e != NULL; e = e->pNextEdge)
+        snprintf(szMessage, OOC_MESSAGE_SIZE, "can't allocate %d MB", iMemoryMB);
+        return ERR_ALGORITHM;
+    }
+    fdInput = openOocTemp();
+    if (fdInput < 0)
+        rc = ERR_ALGORITHM;
+    if (rc == PERT_OK)
+        rc = readOocEdges(&run, stdin, fdInput);
+    if (rc == PERT_OK && run.ullNumEdges == 0)
+    {
+        strcpy(run.szMessage, "no edges");
+        rc = ERR_BAD_INPUT;
+    }
+    if (rc == PERT_OK)
+        rc = sortOocFile(&run, fdInput, run.ullNumEdges, sizeof(OocEdge)
+            , compareOocFrom, &run.fdEdge);
+    if (rc == PERT_OK)
+        rc = sortOocFile(&run, fdInput, run.ullNumEdges, sizeof(OocEdge)
+            , compareOocTo, &fdByTo);
+    if (rc == PERT_OK)
+    {
+        close(fdInput);
+        fdInput = -1;
+        run.fdFirst = openOocTemp();
+        run.fdVertex = openOocTemp();
+        fdQueue = openOocTemp();
+        fdUnsorted = openOocTemp();
+        if (run.fdFirst < 0 || run.fdVertex < 0 || fdQueue < 0 || fdUnsorted < 0)
+            rc = ERR_ALGORITHM;
+    }
+    if (rc == PERT_OK)
+        rc = makeOocVertices(&run, fdByTo, fdQueue, &ullNumSources);
+    if (rc == PERT_OK)
+        rc = levelOocVertices(&run, fdQueue, ullNumSources, fdUnsorted);
+    if (rc == PERT_OK)
+        rc = sortOocFile(&run, fdUnsorted, run.ullNumEdges, sizeof(OocLevelEdge)
+            , compareOocLevel, &run.fdLevel);
+    if (rc == PERT_OK)
+        rc = forwardOocPass(&run);
+    if (rc == PERT_OK)
+        rc = backwardOocPass(&run);
+    if (rc == PERT_OK)
+        rc = writeOocResults(&run, pszResultPath);
+    if (rc == PERT_OK)
+        printf("%lu vertices, %llu edges, %lu levels, maximum TE %" WEIGHT_OUT "\n"
+            , (unsigned long)run.uNumVertices, (unsigned long long)run.ullNumEdges
+            , (unsigned long)run.uNumLevels, run.maxTE);
+    else if (run.szMessage[0] == '\0')
+        snprintf(run.szMessage, sizeof(run.szMessage), "temporary file I/O failed: %s"
+            , strerror(errno));
+    strcpy(szMessage, run.szMessage);
+    if (fdInput >= 0)
+        close(fdInput);
+    if (fdByTo >= 0)
+        close(fdByTo);
+    if (fdQueue >= 0)
+        close(fdQueue);
+    if (fdUnsorted >= 0)
+        close(fdUnsorted);
+    if (run.fdEdge >= 0)
+        close(run.fdEdge);
+    if (run.fdFirst >= 0)
+        close(run.fdFirst);
+    if (run.fdVertex >= 0)
+        close(run.fdVertex);
+    if (run.fdLevel >= 0)
+        close(run.fdLevel);
+    free(run.pArena);
+    return rc;
+}
+/******************** readOocEdges **************************************
+   int readOocEdges(OocRun *pRun, FILE *pFile, int fdOut)
+Purpose:
+    Reads the edges for runOutOfCore and writes them to a file as OocEdge
+    records.
+Parameters:
+    I/O OocRun *pRun            The run.  Sets uNumVertices and
+                                ullNumEdges.
+    I   FILE *pFile             Lines of "from to weight" until EOF.
+    I   int fdOut               The file for the edges.
+Notes:
+    - Blank lines are skipped.
+Returns:
+    PERT_OK - the edges were read.
+    ERR_BAD_INPUT - a line isn't an edge.
+    ERR_ALGORITHM - fdOut couldn't be written.
+**************************************************************************/
+int readOocEdges(OocRun *pRun, FILE *pFile, int fdOut)
+{
+    char szInput[100];
+    unsigned long ulFrom;
+    unsigned long ulTo;
+    char cExtra;                    // something after the weight
+    OocEdge edge;
+    OocStream out;
+    uint64_t ullLine = 0;
+    uint32_t uMaxId = 0;
+    openOocStream(&out, fdOut, 0, 0, pRun->pArena, pRun->size, sizeof(OocEdge));
+    pRun->ullNumEdges = 0;
+    while (fgets(szInput, sizeof(szInput), pFile) != NULL)
+    {
+        ullLine++;
+        if (sscanf(szInput, " %c", &cExtra) != 1)
+            continue;
+        memset(&edge, '\0', sizeof(edge));
+        if (sscanf(szInput, "%lu %lu %" WEIGHT_SCN " %c", &ulFrom, &ulTo, &edge.weight
+            , &cExtra) != 3 || ulFrom > OOC_MAX_ID || ulTo > OOC_MAX_ID)
         {
-            iCnt++;
-            printf("%c %2d  "
-                , graph->vertexM[e->edge.iVertex].cLabel
-                , e->edge.iPath);
+            snprintf(pRun->szMessage, sizeof(pRun->szMessage)
+                , "line %llu isn't 'from to weight'", (unsigned long long)ullLine);
+            return ERR_BAD_INPUT;
         }
-        // if it didn't have successors, print a "-"
-        if (iCnt == 0)
+        edge.uFrom = (uint32_t)ulFrom;
+        edge.uTo = (uint32_t)ulTo;
+        if (edge.uFrom > uMaxId)
+            uMaxId = edge.uFrom;
+        if (edge.uTo > uMaxId)
+            uMaxId = edge.uTo;
+        if (writeOocRecord(&out, &edge, sizeof(edge)) != PERT_OK)
+            return ERR_ALGORITHM;
+        pRun->ullNumEdges++;
+    }
+    pRun->uNumVertices = uMaxId + 1;
+    return flushOocStream(&out);
+}
+/******************** sortOocFile **************************************
+   int sortOocFile(OocRun *pRun, int fdIn, uint64_t ullNumRecords
+       , size_t recordSize, int (*pfnCompare)(const void *, const void *)
+       , int *pfdOut)
+Purpose:
+    Sorts a file of fixed size records that can be larger than memory into
+    a new temporary file (an external merge sort).
+Parameters:
+    I   OocRun *pRun            The run (its pArena is used).
+    I   int fdIn                The records (not changed).
+    I   uint64_t ullNumRecords  Number of records.
+    I   size_t recordSize       Bytes in a record.
+    I   int (*pfnCompare)(...)  qsort comparison of two records.
+    O   int *pfdOut             The sorted records.
+Notes:
+    - Runs that fill pArena are sorted with qsort and written to the same
+      place in a file.  Groups of runs are then merged into a new file
+      (see mergeOocRuns) until there is only one run.  Each run in a group
+      is read OOC_BLOCK_SIZE bytes at a time, so a pass merges about
+      size / OOC_BLOCK_SIZE runs.
+Returns:
+    PERT_OK - sorted.
+    ERR_ALGORITHM - a file couldn't be used.
+**************************************************************************/
+int sortOocFile(OocRun *pRun, int fdIn, uint64_t ullNumRecords, size_t recordSize
+    , int (*pfnCompare)(const void *, const void *), int *pfdOut)
+{
+    uint64_t ullRunLength = pRun->size / recordSize;    // records in a run
+    uint64_t ullFirst;
+    uint64_t ullCount;
+    size_t blockSize;
+    int iFanIn;                     // runs merged at once
+    int fdRuns;
+    int fdMerged;
+    int rc = PERT_OK;
+    fdRuns = openOocTemp();
+    if (fdRuns < 0)
+        return ERR_ALGORITHM;
+    for (ullFirst = 0; ullFirst < ullNumRecords && rc == PERT_OK; ullFirst += ullCount)
+    {
+        ullCount = ullNumRecords - ullFirst;
+        if (ullCount > ullRunLength)
+            ullCount = ullRunLength;
+        rc = readOocAt(fdIn, pRun->pArena, (size_t)ullCount * recordSize
+            , (off_t)(ullFirst * recordSize));
+        if (rc != PERT_OK)
+            break;
+        qsort(pRun->pArena, (size_t)ullCount, recordSize, pfnCompare);
+        rc = writeOocAt(fdRuns, pRun->pArena, (size_t)ullCount * recordSize
+            , (off_t)(ullFirst * recordSize));
+    }
+    blockSize = OOC_BLOCK_SIZE / recordSize * recordSize;
+    if (pRun->size / blockSize < 3)
+        blockSize = pRun->size / 3 / recordSize * recordSize;
+    iFanIn = (int)(pRun->size / blockSize) - 1;     // one block for the output
+    while (rc == PERT_OK && ullRunLength < ullNumRecords)
+    {
+        fdMerged = openOocTemp();
+        if (fdMerged < 0)
+            rc = ERR_ALGORITHM;
+        for (ullFirst = 0; ullFirst < ullNumRecords && rc == PERT_OK
+            ; ullFirst += ullRunLength * iFanIn)
+            rc = mergeOocRuns(fdRuns, fdMerged, ullFirst, ullRunLength, iFanIn
+                , ullNumRecords, recordSize, pfnCompare, pRun->pArena, blockSize);
+        close(fdRuns);
+        fdRuns = fdMerged;
+        ullRunLength *= iFanIn;
+    }
+    if (rc != PERT_OK)
+    {
+        if (fdRuns >= 0)
+            close(fdRuns);
+        return rc;
+    }
+    *pfdOut = fdRuns;
+    return PERT_OK;
+}
+/******************** mergeOocRuns **************************************
+   int mergeOocRuns(int fdIn, int fdOut, uint64_t ullFirst
+       , uint64_t ullRunLength, int iNumRuns, uint64_t ullNumRecords
+       , size_t recordSize, int (*pfnCompare)(const void *, const void *)
+       , char *pBuffer, size_t blockSize)
+Purpose:
+    Merges a group of sorted runs into one run for sortOocFile.
+Parameters:
+    I   int fdIn                The runs.
+    I   int fdOut               The file for the merged run, which is
+                                written at the same place as its runs.
+    I   uint64_t ullFirst       First record of the group.
+    I   uint64_t ullRunLength   Records in each run (the last can be
+                                shorter).
+    I   int iNumRuns            Runs in the group (some can be past
+                                ullNumRecords).
+    I   uint64_t ullNumRecords  Records in fdIn.
+    I   size_t recordSize       Bytes in a record.
+    I   int (*pfnCompare)(...)  qsort comparison of two records.
+    I   char *pBuffer           iNumRuns + 1 blocks of memory.
+    I   size_t blockSize        Bytes in a block (whole records).
+Notes:
+    - The run with the smallest next record is found with a binary heap.
+Returns:
+    PERT_OK - merged.
+    ERR_ALGORITHM - a file couldn't be used or the heap couldn't be
+                    allocated.
+**************************************************************************/
+int mergeOocRuns(int fdIn, int fdOut, uint64_t ullFirst, uint64_t ullRunLength
+    , int iNumRuns, uint64_t ullNumRecords, size_t recordSize
+    , int (*pfnCompare)(const void *, const void *), char *pBuffer, size_t blockSize)
+{
+    OocStream *streamM;             // each run
+    char *pRecordM;                 // each run's next record
+    int *iHeapM;                    // runs with records, smallest next first
+    int iNumHeap = 0;
+    OocStream out;
+    uint64_t ullStart;
+    uint64_t ullEnd;
+    int iRun;
+    int i;
+    int iChild;
+    int iRead;
+    int rc = PERT_OK;
+    streamM = (OocStream *)malloc(iNumRuns * sizeof(OocStream));
+    pRecordM = (char *)malloc(iNumRuns * recordSize);
+    iHeapM = (int *)malloc(iNumRuns * sizeof(int));
+    if (streamM == NULL || pRecordM == NULL || iHeapM == NULL)
+        rc = ERR_ALGORITHM;
+    for (iRun = 0; iRun < iNumRuns && rc == PERT_OK; iRun++)
+    {
+        ullStart = ullFirst + iRun * ullRunLength;
+        if (ullStart >= ullNumRecords)
+            break;
+        ullEnd = ullStart + ullRunLength;
+        if (ullEnd > ullNumRecords)
+            ullEnd = ullNumRecords;
+        openOocStream(&streamM[iRun], fdIn, (off_t)(ullStart * recordSize)
+            , (off_t)(ullEnd * recordSize), pBuffer + iRun * blockSize, blockSize
+            , recordSize);
+        if (readOocRecord(&streamM[iRun], pRecordM + iRun * recordSize, recordSize) <= 0)
+            rc = ERR_ALGORITHM;
+        // add it to the heap
+        for (i = iNumHeap++; i > 0; i = (i - 1) / 2)
         {
-            printf("-     ");
-            iCnt = 1;
+            if (pfnCompare(pRecordM + iHeapM[(i - 1) / 2] * recordSize
+                , pRecordM + iRun * recordSize) <= 0)
+                break;
+            iHeapM[i] = iHeapM[(i - 1) / 2];
         }
-        // determine the variable-spaced amount for including spaces to get the 
-        // predecessor list to print in a specific column
-        printSpaces("      ", 4 - iCnt);
-        printf("    ");
-        iCnt = 0;
-        // Print each of its predecessors
-        for (e = graph->vertexM[iv].predecessorList; e != NULL; e = e->pNextEdge)
+        iHeapM[i] = iRun;
+    }
+    openOocStream(&out, fdOut, (off_t)(ullFirst * recordSize), 0
+        , pBuffer + iNumRuns * blockSize, blockSize, recordSize);
+    while (iNumHeap > 0 && rc == PERT_OK)
+    {
+        iRun = iHeapM[0];
+        rc = writeOocRecord(&out, pRecordM + iRun * recordSize, recordSize);
+        iRead = readOocRecord(&streamM[iRun], pRecordM + iRun * recordSize, recordSize);
+        if (iRead < 0)
+            rc = ERR_ALGORITHM;
+        if (iRead <= 0)
+            iRun = iHeapM[--iNumHeap];
+        // move iRun down to its place from the top of the heap
+        for (i = 0; (iChild = 2 * i + 1) < iNumHeap; i = iChild)
         {
-            printf("%c %2d "
-                , graph->vertexM[e->edge.iVertex].cLabel
-                , e->edge.iPath);
-            iCnt++;
+            if (iChild + 1 < iNumHeap
+                && pfnCompare(pRecordM + iHeapM[iChild + 1] * recordSize
+                    , pRecordM + iHeapM[iChild] * recordSize) < 0)
+                iChild++;
+            if (pfnCompare(pRecordM + iRun * recordSize
+                , pRecordM + iHeapM[iChild] * recordSize) <= 0)
+                break;
+            iHeapM[i] = iHeapM[iChild];
         }
-        // if it didn't have predecessors, print a "-"
-        if (iCnt == 0)
-            printf("-");
-        printf("\n");
+        if (iNumHeap > 0)
+            iHeapM[i] = iRun;
     }
+    if (rc == PERT_OK)
+        rc = flushOocStream(&out);
+    free(streamM);
+    free(pRecordM);
+    free(iHeapM);
+    return rc;
 }
-/******************** printSpaces **************************************
-void printSpaces(char szSpaces[], int iRepeat)
+/******************** makeOocVertices **************************************
+   int makeOocVertices(OocRun *pRun, int fdByTo, int fdQueue
+       , uint64_t *pullNumSources)
 Purpose:
-    Prints spaces across a line of output to help with consistent columns.
+    Makes the vertex file and the index of each vertex's first edge and
+    queues the sources as level 0.
 Parameters:
-    I   char szSpaces           A string of spaces to be printed
-    I   iRepeat                 The number of times to print that string
-                                of spaces.   
+    I/O OocRun *pRun            The run.  Writes fdFirst (uNumVertices + 1
+                                entries) and fdVertex.
+    I   int fdByTo              The edges sorted by TO vertex.
+    I   int fdQueue             File for the ids of the sources.
+    O   uint64_t *pullNumSources  Number of sources.
+Notes:
+    - Streams the edges sorted by FROM vertex and by TO vertex together
+      with the vertex ids, so every file is read or written in order.
+    - TE starts at WEIGHT_MIN except for the sources, and the distance to
+      the sinks starts at WEIGHT_MIN except for the sinks.
 Returns:
-    n/a
+    PERT_OK - made.
+    ERR_ALGORITHM - a file couldn't be used.
 **************************************************************************/
-void printSpaces(char szSpaces[], int iRepeat)
+int makeOocVertices(OocRun *pRun, int fdByTo, int fdQueue, uint64_t *pullNumSources)
 {
-    int i;
-    for (i = 0; i < iRepeat; i++)
+    size_t blockSize = pRun->size / 5;
+    OocStream byFrom;
+    OocStream byTo;
+    OocStream first;
+    OocStream vertexOut;
+    OocStream queue;
+    OocEdge edgeFrom;
+    OocEdge edgeTo;
+    OocVertex vertex;
+    uint64_t ullNext = 0;           // edges before vertex v's
+    uint64_t ullOutDegree;
+    int iFrom;                      // readOocRecord results
+    int iTo;
+    uint32_t v;
+    openOocStream(&byFrom, pRun->fdEdge, 0, (off_t)(pRun->ullNumEdges * sizeof(OocEdge))
+        , pRun->pArena, blockSize, sizeof(OocEdge));
+    openOocStream(&byTo, fdByTo, 0, (off_t)(pRun->ullNumEdges * sizeof(OocEdge))
+        , pRun->pArena + blockSize, blockSize, sizeof(OocEdge));
+    openOocStream(&first, pRun->fdFirst, 0, 0, pRun->pArena + 2 * blockSize, blockSize
+        , sizeof(uint64_t));
+    openOocStream(&vertexOut, pRun->fdVertex, 0, 0, pRun->pArena + 3 * blockSize
+        , blockSize, sizeof(OocVertex));
+    openOocStream(&queue, fdQueue, 0, 0, pRun->pArena + 4 * blockSize, blockSize
+        , sizeof(uint32_t));
+    *pullNumSources = 0;
+    iFrom = readOocRecord(&byFrom, &edgeFrom, sizeof(edgeFrom));
+    iTo = readOocRecord(&byTo, &edgeTo, sizeof(edgeTo));
+    for (v = 0; v < pRun->uNumVertices; v++)
     {
-        printf("%s", szSpaces);
+        if (writeOocRecord(&first, &ullNext, sizeof(ullNext)) != PERT_OK)
+            return ERR_ALGORITHM;
+        for (ullOutDegree = 0; iFrom > 0 && edgeFrom.uFrom == v; ullOutDegree++)
+            iFrom = readOocRecord(&byFrom, &edgeFrom, sizeof(edgeFrom));
+        ullNext += ullOutDegree;
+        memset(&vertex, '\0', sizeof(vertex));
+        for (; iTo > 0 && edgeTo.uTo == v; vertex.uInDegree++)
+            iTo = readOocRecord(&byTo, &edgeTo, sizeof(edgeTo));
+        if (iFrom < 0 || iTo < 0)
+            return ERR_ALGORITHM;
+        vertex.uLevel = vertex.uInDegree == 0 ? 0 : OOC_NO_LEVEL;
+        vertex.te = vertex.uInDegree == 0 ? 0 : WEIGHT_MIN;
+        vertex.sink = ullOutDegree == 0 ? 0 : WEIGHT_MIN;
+        if (writeOocRecord(&vertexOut, &vertex, sizeof(vertex)) != PERT_OK)
+            return ERR_ALGORITHM;
+        if (vertex.uInDegree == 0)
+        {
+            if (writeOocRecord(&queue, &v, sizeof(v)) != PERT_OK)
+                return ERR_ALGORITHM;
+            (*pullNumSources)++;
+        }
+    }
+    if (writeOocRecord(&first, &ullNext, sizeof(ullNext)) != PERT_OK
+        || flushOocStream(&first) != PERT_OK
+        || flushOocStream(&vertexOut) != PERT_OK
+        || flushOocStream(&queue) != PERT_OK)
+        return ERR_ALGORITHM;
+    return PERT_OK;
+}
+/******************** levelOocVertices **************************************
+   int levelOocVertices(OocRun *pRun, int fdQueue, uint64_t ullNumSources
+       , int fdOut)
+Purpose:
+    Places each vertex in a topological level (one more than the highest
+    level of its predecessors) and writes each edge with its FROM vertex's
+    level.
+Parameters:
+    I/O OocRun *pRun            The run.  Sets uNumLevels and each vertex's
+                                uLevel.
+    I   int fdQueue             The sources' ids.  The other vertices' ids
+                                are added in level order.
+    I   uint64_t ullNumSources  Number of sources.
+    I   int fdOut               File for the OocLevelEdge records, in the
+                                order they are found.
+Notes:
+    - Kahn's algorithm a level at a time: the edges of each vertex in the
+      level are read from fdEdge using fdFirst, and their TO vertices'
+      uInDegree is decremented.  The decrements are sorted and applied in
+      batches (see applyOocDecrements) so the vertex file is read in order;
+      a vertex whose last predecessor is removed goes in the next level.
+Returns:
+    PERT_OK - every vertex has a level.
+    ERR_BAD_INPUT - the graph has a cycle.
+    ERR_ALGORITHM - a file couldn't be used.
+**************************************************************************/
+int levelOocVertices(OocRun *pRun, int fdQueue, uint64_t ullNumSources, int fdOut)
+{
+    uint32_t *uDecrementM = (uint32_t *)pRun->pArena;   // TO vertices to decrement
+    size_t iMaxDecrements = pRun->size / 2 / sizeof(uint32_t);
+    size_t iNumDecrements = 0;
+    char *pBlocks = pRun->pArena + iMaxDecrements * sizeof(uint32_t);
+    size_t blockSize = (pRun->size - iMaxDecrements * sizeof(uint32_t)) / 4;
+    uint64_t ullLevelStart = 0;     // the level's part of fdQueue
+    uint64_t ullLevelEnd = ullNumSources;
+    uint64_t ullNumQueued = ullNumSources;
+    uint64_t ullFirstM[2];          // vertex v's edges
+    uint32_t uLevel = 0;
+    uint32_t v;
+    OocStream queueIn;
+    OocStream queueOut;
+    OocStream edgeIn;
+    OocStream levelOut;
+    OocEdge edge;
+    OocLevelEdge levelEdge;
+    int iRead;
+    int iEdgeRead;
+    openOocStream(&queueOut, fdQueue, (off_t)(ullNumSources * sizeof(uint32_t)), 0
+        , pBlocks + blockSize, blockSize, sizeof(uint32_t));
+    openOocStream(&levelOut, fdOut, 0, 0, pBlocks + 3 * blockSize, blockSize
+        , sizeof(OocLevelEdge));
+    memset(&levelEdge, '\0', sizeof(levelEdge));
+    while (ullLevelStart < ullLevelEnd)
+    {
+        openOocStream(&queueIn, fdQueue, (off_t)(ullLevelStart * sizeof(uint32_t))
+            , (off_t)(ullLevelEnd * sizeof(uint32_t)), pBlocks, blockSize
+            , sizeof(uint32_t));
+        while ((iRead = readOocRecord(&queueIn, &v, sizeof(v))) > 0)
+        {
+            if (readOocAt(pRun->fdFirst, ullFirstM, sizeof(ullFirstM)
+                , (off_t)v * sizeof(uint64_t)) != PERT_OK)
+                return ERR_ALGORITHM;
+            openOocStream(&edgeIn, pRun->fdEdge, (off_t)(ullFirstM[0] * sizeof(OocEdge))
+                , (off_t)(ullFirstM[1] * sizeof(OocEdge)), pBlocks + 2 * blockSize
+                , blockSize, sizeof(OocEdge));
+            while ((iEdgeRead = readOocRecord(&edgeIn, &edge, sizeof(edge))) > 0)
+            {
+                levelEdge.uLevel = uLevel;
+                levelEdge.uFrom = edge.uFrom;
+                levelEdge.uTo = edge.uTo;
+                levelEdge.weight = edge.weight;
+                if (writeOocRecord(&levelOut, &levelEdge, sizeof(levelEdge)) != PERT_OK)
+                    return ERR_ALGORITHM;
+                if (iNumDecrements == iMaxDecrements)
+                {
+                    if (applyOocDecrements(pRun, uDecrementM, iNumDecrements, uLevel + 1
+                        , &queueOut, &ullNumQueued) != PERT_OK)
+                        return ERR_ALGORITHM;
+                    iNumDecrements = 0;
+                }
+                uDecrementM[iNumDecrements++] = edge.uTo;
+            }
+            if (iEdgeRead < 0)
+                return ERR_ALGORITHM;
+        }
+        if (iRead < 0
+            || applyOocDecrements(pRun, uDecrementM, iNumDecrements, uLevel + 1
+                , &queueOut, &ullNumQueued) != PERT_OK
+            || flushOocStream(&queueOut) != PERT_OK)
+            return ERR_ALGORITHM;
+        iNumDecrements = 0;
+        ullLevelStart = ullLevelEnd;
+        ullLevelEnd = ullNumQueued;
+        uLevel++;
+    }
+    if (flushOocStream(&levelOut) != PERT_OK)
+        return ERR_ALGORITHM;
+    pRun->uNumLevels = uLevel;
+    if (ullNumQueued < pRun->uNumVertices)
+    {
+        snprintf(pRun->szMessage, sizeof(pRun->szMessage)
+            , "the graph has a cycle (%llu vertices aren't in a level)"
+            , (unsigned long long)(pRun->uNumVertices - ullNumQueued));
+        return ERR_BAD_INPUT;
+    }
+    return PERT_OK;
+}
+/******************** applyOocDecrements **************************************
+   int applyOocDecrements(OocRun *pRun, uint32_t uVertexM[], size_t iNum
+       , uint32_t uLevel, OocStream *pQueue, uint64_t *pullNumQueued)
+Purpose:
+    Removes a batch of edges from their TO vertices' uInDegree for
+    levelOocVertices.
+Parameters:
+    I/O OocRun *pRun            The run.
+    I/O uint32_t uVertexM[]     The TO vertex of each edge (sorted here).
+    I   size_t iNum             Number of edges.
+    I   uint32_t uLevel         The level of a vertex left without
+                                predecessors.
+    I/O OocStream *pQueue       Such vertices are written here.
+    I/O uint64_t *pullNumQueued Number of vertices queued.
+Returns:
+    PERT_OK - applied.
+    ERR_ALGORITHM - a file couldn't be used.
+**************************************************************************/
+int applyOocDecrements(OocRun *pRun, uint32_t uVertexM[], size_t iNum, uint32_t uLevel
+    , OocStream *pQueue, uint64_t *pullNumQueued)
+{
+    OocVertex vertex;
+    off_t offset;
+    size_t i;
+    size_t j;
+    qsort(uVertexM, iNum, sizeof(uint32_t), compareOocIds);
+    for (i = 0; i < iNum; i = j)
+    {
+        for (j = i + 1; j < iNum && uVertexM[j] == uVertexM[i]; j++)
+            ;
+        offset = (off_t)uVertexM[i] * sizeof(OocVertex);
+        if (readOocAt(pRun->fdVertex, &vertex, sizeof(vertex), offset) != PERT_OK)
+            return ERR_ALGORITHM;
+        vertex.uInDegree -= (uint32_t)(j - i);
+        if (vertex.uInDegree == 0)
+        {
+            vertex.uLevel = uLevel;
+            if (writeOocRecord(pQueue, &uVertexM[i], sizeof(uint32_t)) != PERT_OK)
+                return ERR_ALGORITHM;
+            (*pullNumQueued)++;
+        }
+        if (writeOocAt(pRun->fdVertex, &vertex, sizeof(vertex), offset) != PERT_OK)
+            return ERR_ALGORITHM;
+    }
+    return PERT_OK;
+}
+/******************** forwardOocPass **************************************
+   int forwardOocPass(OocRun *pRun)
+Purpose:
+    Computes each vertex's TE from the edges sorted by level.
+Parameters:
+    I/O OocRun *pRun            The run.  Sets each vertex's te and maxTE.
+Notes:
+    - The edges are read in level order.  Each edge's FROM vertex's TE is
+      final since its predecessors are in lower levels, so an edge gives
+      its TO vertex a candidate TE.  The candidates are kept in memory and
+      applied (see applyOocUpdates) when they fill half of pArena and when
+      the level changes, before any of their vertices are read.
+Returns:
+    PERT_OK - computed.
+    ERR_ALGORITHM - a file couldn't be used.
+**************************************************************************/
+int forwardOocPass(OocRun *pRun)
+{
+    OocUpdate *updateM = (OocUpdate *)pRun->pArena;
+    size_t iMaxUpdates = pRun->size / 2 / sizeof(OocUpdate);
+    size_t iNumUpdates = 0;
+    char *pBlock = pRun->pArena + iMaxUpdates * sizeof(OocUpdate);
+    OocStream in;
+    OocLevelEdge edge;
+    OocVertex vertex;
+    uint32_t uLevel = 0;
+    uint32_t uFrom = 0;
+    int bHaveFrom = FALSE;          // TRUE if vertex is uFrom's
+    int iRead;
+    pRun->maxTE = 0;
+    openOocStream(&in, pRun->fdLevel, 0, (off_t)(pRun->ullNumEdges * sizeof(OocLevelEdge))
+        , pBlock, pRun->size - iMaxUpdates * sizeof(OocUpdate), sizeof(OocLevelEdge));
+    while ((iRead = readOocRecord(&in, &edge, sizeof(edge))) > 0)
+    {
+        if (edge.uLevel != uLevel || iNumUpdates == iMaxUpdates)
+        {
+            if (applyOocUpdates(pRun, updateM, iNumUpdates, FALSE) != PERT_OK)
+                return ERR_ALGORITHM;
+            iNumUpdates = 0;
+            uLevel = edge.uLevel;
+        }
+        if (!bHaveFrom || edge.uFrom != uFrom)
+        {
+            if (readOocAt(pRun->fdVertex, &vertex, sizeof(vertex)
+                , (off_t)edge.uFrom * sizeof(OocVertex)) != PERT_OK)
+                return ERR_ALGORITHM;
+            uFrom = edge.uFrom;
+            bHaveFrom = TRUE;
+        }
+        updateM[iNumUpdates].uVertex = edge.uTo;
+        updateM[iNumUpdates].value = vertex.te + edge.weight;
+        iNumUpdates++;
+    }
+    if (iRead < 0 || applyOocUpdates(pRun, updateM, iNumUpdates, FALSE) != PERT_OK)
+        return ERR_ALGORITHM;
+    return PERT_OK;
+}
+/******************** backwardOocPass **************************************
+   int backwardOocPass(OocRun *pRun)
+Purpose:
+    Computes each vertex's distance to the sinks from the edges sorted by
+    level.
+Parameters:
+    I/O OocRun *pRun            The run.  Sets each vertex's sink.
+Notes:
+    - Like forwardOocPass, but the edge file is read OOC_BLOCK_SIZE bytes
+      at a time from its end, so the TO vertex of an edge (in a higher
+      level) has its final distance.
+Returns:
+    PERT_OK - computed.
+    ERR_ALGORITHM - a file couldn't be used.
+**************************************************************************/
+int backwardOocPass(OocRun *pRun)
+{
+    OocUpdate *updateM = (OocUpdate *)pRun->pArena;
+    size_t iMaxUpdates = pRun->size / 2 / sizeof(OocUpdate);
+    size_t iNumUpdates = 0;
+    char *pBlock = pRun->pArena + iMaxUpdates * sizeof(OocUpdate);
+    size_t blockSize = OOC_BLOCK_SIZE / sizeof(OocLevelEdge) * sizeof(OocLevelEdge);
+    size_t size;
+    size_t i;
+    off_t offset = (off_t)(pRun->ullNumEdges * sizeof(OocLevelEdge));
+    OocLevelEdge edge;
+    OocVertex vertex;
+    uint32_t uLevel = pRun->uNumLevels;
+    while (offset > 0)
+    {
+        size = blockSize;
+        if ((off_t)size > offset)
+            size = (size_t)offset;
+        offset -= size;
+        if (readOocAt(pRun->fdLevel, pBlock, size, offset) != PERT_OK)
+            return ERR_ALGORITHM;
+        for (i = size / sizeof(OocLevelEdge); i > 0; i--)
+        {
+            memcpy(&edge, pBlock + (i - 1) * sizeof(OocLevelEdge), sizeof(edge));
+            if (edge.uLevel != uLevel || iNumUpdates == iMaxUpdates)
+            {
+                if (applyOocUpdates(pRun, updateM, iNumUpdates, TRUE) != PERT_OK)
+                    return ERR_ALGORITHM;
+                iNumUpdates = 0;
+                uLevel = edge.uLevel;
+            }
+            if (readOocAt(pRun->fdVertex, &vertex, sizeof(vertex)
+                , (off_t)edge.uTo * sizeof(OocVertex)) != PERT_OK)
+                return ERR_ALGORITHM;
+            updateM[iNumUpdates].uVertex = edge.uFrom;
+            updateM[iNumUpdates].value = vertex.sink + edge.weight;
+            iNumUpdates++;
+        }
+    }
+    return applyOocUpdates(pRun, updateM, iNumUpdates, TRUE);
+}
+/******************** applyOocUpdates **************************************
+   int applyOocUpdates(OocRun *pRun, OocUpdate updateM[], size_t iNum
+       , int bSink)
+Purpose:
+    Raises vertices' TE or distance to the sinks to the largest of their
+    candidates.
+Parameters:
+    I/O OocRun *pRun            The run.  maxTE is raised with TE.
+    I/O OocUpdate updateM[]     The candidates (sorted here by vertex).
+    I   size_t iNum             Number of candidates.
+    I   int bSink               TRUE for the distance to the sinks, FALSE
+                                for TE.
+Returns:
+    PERT_OK - applied.
+    ERR_ALGORITHM - the vertex file couldn't be used.
+**************************************************************************/
+int applyOocUpdates(OocRun *pRun, OocUpdate updateM[], size_t iNum, int bSink)
+{
+    OocVertex vertex;
+    Weight *pValue = bSink ? &vertex.sink : &vertex.te;
+    Weight value;
+    off_t offset;
+    size_t i;
+    size_t j;
+    qsort(updateM, iNum, sizeof(OocUpdate), compareOocUpdates);
+    for (i = 0; i < iNum; i = j)
+    {
+        value = updateM[i].value;
+        for (j = i + 1; j < iNum && updateM[j].uVertex == updateM[i].uVertex; j++)
+        {
+            if (updateM[j].value > value)
+                value = updateM[j].value;
+        }
+        offset = (off_t)updateM[i].uVertex * sizeof(OocVertex);
+        if (readOocAt(pRun->fdVertex, &vertex, sizeof(vertex), offset) != PERT_OK)
+            return ERR_ALGORITHM;
+        if (!(value > *pValue))
+            continue;
+        *pValue = value;
+        if (!bSink && value > pRun->maxTE)
+            pRun->maxTE = value;
+        if (writeOocAt(pRun->fdVertex, &vertex, sizeof(vertex), offset) != PERT_OK)
+            return ERR_ALGORITHM;
+    }
+    return PERT_OK;
+}
+/******************** writeOocResults **************************************
+   int writeOocResults(OocRun *pRun, char *pszResultPath)
+Purpose:
+    Writes the result file of an out-of-core run.
+Parameters:
+    I/O OocRun *pRun            The run with TE and the distances to the
+                                sinks computed.
+    I   char *pszResultPath     The file (replaced if it exists).
+Notes:
+    - The file is sized first and then written through a windowSize
+      mapping that moves along it (see writeOocMapped), while the vertex
+      file is read in order.
+    - TL is maxTE less the distance to the sinks.
+Returns:
+    PERT_OK - written.
+    ERR_ALGORITHM - a file couldn't be used.
+**************************************************************************/
+int writeOocResults(OocRun *pRun, char *pszResultPath)
+{
+    OocMap map;
+    OocHeader header;
+    OocResult result;
+    OocVertex vertex;
+    OocStream in;
+    int iRead;
+    int rc = PERT_OK;
+    memset(&map, '\0', sizeof(map));
+    map.fd = open(pszResultPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (map.fd < 0)
+    {
+        snprintf(pRun->szMessage, sizeof(pRun->szMessage), "can't create '%s'"
+            , pszResultPath);
+        return ERR_ALGORITHM;
+    }
+    map.size = (off_t)sizeof(OocHeader) + (off_t)pRun->uNumVertices * sizeof(OocResult);
+    map.windowSize = pRun->windowSize;
+    if (ftruncate(map.fd, map.size) != 0)
+        rc = ERR_ALGORITHM;
+    memset(&header, '\0', sizeof(header));
+    memcpy(header.szMagic, OOC_MAGIC, sizeof(header.szMagic));
+    header.cWeightKind = WEIGHT_KIND;
+    header.ullNumVertices = pRun->uNumVertices;
+    header.maxTE = pRun->maxTE;
+    if (rc == PERT_OK)
+        rc = writeOocMapped(&map, &header, sizeof(header));
+    openOocStream(&in, pRun->fdVertex, 0, (off_t)pRun->uNumVertices * sizeof(OocVertex)
+        , pRun->pArena, pRun->size, sizeof(OocVertex));
+    memset(&result, '\0', sizeof(result));
+    while (rc == PERT_OK && (iRead = readOocRecord(&in, &vertex, sizeof(vertex))) != 0)
+    {
+        if (iRead < 0)
+        {
+            rc = ERR_ALGORITHM;
+            break;
+        }
+        result.te = vertex.te;
+        result.tl = pRun->maxTE - vertex.sink;
+        result.slack = result.tl - result.te;
+        rc = writeOocMapped(&map, &result, sizeof(result));
+    }
+    if (map.pWindow != NULL)
+        munmap(map.pWindow, map.length);
+    if (close(map.fd) != 0)
+        rc = ERR_ALGORITHM;
+    if (rc != PERT_OK)
+        snprintf(pRun->szMessage, sizeof(pRun->szMessage), "can't write '%s': %s"
+            , pszResultPath, strerror(errno));
+    return rc;
+}
+/******************** writeOocMapped **************************************
+   int writeOocMapped(OocMap *pMap, void *pData, size_t size)
+Purpose:
+    Copies bytes to the next part of a file through its mapping, moving the
+    mapping along the file as needed.
+Parameters:
+    I/O OocMap *pMap            The file being written.
+    I   void *pData             The bytes.
+    I   size_t size             Number of bytes.
+Notes:
+    - Windows start at multiples of windowSize, which is whole pages, and
+      a record can span two of them.  Only one is mapped at a time, so the
+      pages written are released as the mapping moves.
+Returns:
+    PERT_OK - copied.
+    ERR_ALGORITHM - the file couldn't be mapped.
+**************************************************************************/
+int writeOocMapped(OocMap *pMap, void *pData, size_t size)
+{
+    char *pBytes = (char *)pData;
+    size_t iCopy;
+    while (size > 0)
+    {
+        if (pMap->pWindow == NULL || pMap->next >= pMap->start + (off_t)pMap->length)
+        {
+            if (pMap->pWindow != NULL)
+                munmap(pMap->pWindow, pMap->length);
+            pMap->start = pMap->next / pMap->windowSize * pMap->windowSize;
+            pMap->length = pMap->windowSize;
+            if (pMap->start + (off_t)pMap->length > pMap->size)
+                pMap->length = (size_t)(pMap->size - pMap->start);
+            pMap->pWindow = (char *)mmap(NULL, pMap->length, PROT_READ | PROT_WRITE
+                , MAP_SHARED, pMap->fd, pMap->start);
+            if (pMap->pWindow == (char *)MAP_FAILED)
+            {
+                pMap->pWindow = NULL;
+                return ERR_ALGORITHM;
+            }
+        }
+        iCopy = (size_t)(pMap->start + (off_t)pMap->length - pMap->next);
+        if (iCopy > size)
+            iCopy = size;
+        memcpy(pMap->pWindow + (pMap->next - pMap->start), pBytes, iCopy);
+        pMap->next += iCopy;
+        pBytes += iCopy;
+        size -= iCopy;
+    }
+    return PERT_OK;
+}
+/******************** openOocTemp **************************************
+   int openOocTemp()
+Purpose:
+    Creates a temporary file in $TMPDIR (or /tmp) that is removed when it
+    is closed.
+Returns:
+    its file descriptor, or -1 if it couldn't be created.
+**************************************************************************/
+int openOocTemp()
+{
+    char szPath[4096];
+    char *pszDir = getenv("TMPDIR");
+    int fd;
+    if (pszDir == NULL || pszDir[0] == '\0')
+        pszDir = "/tmp";
+    if (snprintf(szPath, sizeof(szPath), "%s/p6oocXXXXXX", pszDir) >= (int)sizeof(szPath))
+        return -1;
+    fd = mkstemp(szPath);
+    if (fd >= 0)
+        unlink(szPath);
+    return fd;
+}
+/******************** OocStream functions **************************************
+   void openOocStream(OocStream *pStream, int fd, off_t offset, off_t end
+       , char *pBuffer, size_t size, size_t recordSize)
+   int readOocRecord(OocStream *pStream, void *pRecord, size_t recordSize)
+   int writeOocRecord(OocStream *pStream, void *pRecord, size_t recordSize)
+   int flushOocStream(OocStream *pStream)
+Purpose:
+    Read or write the records of a file in order through a buffer.  A
+    stream starts at offset; a stream being read stops at end.
+Notes:
+    - At most OOC_BLOCK_SIZE bytes of the buffer are used, in whole 
+      records, so a record is never split.  Larger transfers don't read
+      any faster, and writing a file in very large pieces made the small
+      reads and writes of the vertex file several times slower.
+    - A written stream must be flushed to write its last records.
+Returns:
+    readOocRecord: 1 - a record was read, 0 - end reached, -1 - error.
+    writeOocRecord and flushOocStream: PERT_OK or ERR_ALGORITHM.
+**************************************************************************/
+void openOocStream(OocStream *pStream, int fd, off_t offset, off_t end
+    , char *pBuffer, size_t size, size_t recordSize)
+{
+    pStream->fd = fd;
+    pStream->pBuffer = pBuffer;
+    if (size > OOC_BLOCK_SIZE)
+        size = OOC_BLOCK_SIZE;
+    pStream->size = size / recordSize * recordSize;
+    pStream->iNext = 0;
+    pStream->iEnd = 0;
+    pStream->offset = offset;
+    pStream->end = end;
+}
+int readOocRecord(OocStream *pStream, void *pRecord, size_t recordSize)
+{
+    size_t size;
+    if (pStream->iNext >= pStream->iEnd)
+    {
+        if (pStream->offset >= pStream->end)
+            return 0;
+        size = pStream->size;
+        if ((off_t)size > pStream->end - pStream->offset)
+            size = (size_t)(pStream->end - pStream->offset);
+        if (readOocAt(pStream->fd, pStream->pBuffer, size, pStream->offset) != PERT_OK)
+            return -1;
+        pStream->offset += size;
+        pStream->iNext = 0;
+        pStream->iEnd = size;
     }
+    memcpy(pRecord, pStream->pBuffer + pStream->iNext, recordSize);
+    pStream->iNext += recordSize;
+    return 1;
+}
+int writeOocRecord(OocStream *pStream, void *pRecord, size_t recordSize)
+{
+    if (pStream->iNext + recordSize > pStream->size && flushOocStream(pStream) != PERT_OK)
+        return ERR_ALGORITHM;
+    memcpy(pStream->pBuffer + pStream->iNext, pRecord, recordSize);
+    pStream->iNext += recordSize;
+    return PERT_OK;
+}
+int flushOocStream(OocStream *pStream)
+{
+    if (writeOocAt(pStream->fd, pStream->pBuffer, pStream->iNext, pStream->offset) != PERT_OK)
+        return ERR_ALGORITHM;
+    pStream->offset += pStream->iNext;
+    pStream->iNext = 0;
+    return PERT_OK;
+}
+/******************** readOocAt, writeOocAt **************************************
+   int readOocAt(int fd, void *pData, size_t size, off_t offset)
+   int writeOocAt(int fd, void *pData, size_t size, off_t offset)
+Purpose:
+    Read or write all of size bytes at a file offset, retrying partial
+    transfers.
+Returns:
+    PERT_OK - done.
+    ERR_ALGORITHM - an error, or the file ended before size bytes were
+                    read.
+**************************************************************************/
+int readOocAt(int fd, void *pData, size_t size, off_t offset)
+{
+    char *pBytes = (char *)pData;
+    ssize_t iCount;
+    while (size > 0)
+    {
+        iCount = pread(fd, pBytes, size, offset);
+        if (iCount < 0 && errno == EINTR)
+            continue;
+        if (iCount <= 0)
+            return ERR_ALGORITHM;
+        pBytes += iCount;
+        size -= (size_t)iCount;
+        offset += iCount;
+    }
+    return PERT_OK;
+}
+int writeOocAt(int fd, void *pData, size_t size, off_t offset)
+{
+    char *pBytes = (char *)pData;
+    ssize_t iCount;
+    while (size > 0)
+    {
+        iCount = pwrite(fd, pBytes, size, offset);
+        if (iCount < 0 && errno == EINTR)
+            continue;
+        if (iCount <= 0)
+            return ERR_ALGORITHM;
+        pBytes += iCount;
+        size -= (size_t)iCount;
+        offset += iCount;
+    }
+    return PERT_OK;
+}
+#else
+int runOutOfCore(char *pszResultPath, int iMemoryMB, char szMessage[])
+{
+    strcpy(szMessage, "out-of-core mode needs pread and mmap");
+    return ERR_COMMAND_LINE;
+}
+#endif
+/******************** out-of-core comparisons **************************************
+   int compareOocFrom(const void *p1, const void *p2)
+   int compareOocTo(const void *p1, const void *p2)
+   int compareOocLevel(const void *p1, const void *p2)
+   int compareOocUpdates(const void *p1, const void *p2)
+   int compareOocIds(const void *p1, const void *p2)
+Purpose:
+    qsort comparisons for the out-of-core records:
+        compareOocFrom      OocEdge by FROM vertex and then TO vertex
+        compareOocTo        OocEdge by TO vertex
+        compareOocLevel     OocLevelEdge by level, FROM vertex and TO vertex
+        compareOocUpdates   OocUpdate by vertex
+        compareOocIds       uint32_t vertex ids
+Returns:
+    < 0, 0, > 0 like strcmp
+**************************************************************************/
+int compareOocFrom(const void *p1, const void *p2)
+{
+    const OocEdge *pEdge1 = (const OocEdge *)p1;
+    const OocEdge *pEdge2 = (const OocEdge *)p2;
+    if (pEdge1->uFrom != pEdge2->uFrom)
+        return pEdge1->uFrom < pEdge2->uFrom ? -1 : 1;
+    if (pEdge1->uTo != pEdge2->uTo)
+        return pEdge1->uTo < pEdge2->uTo ? -1 : 1;
+    return 0;
+}
+int compareOocTo(const void *p1, const void *p2)
+{
+    const OocEdge *pEdge1 = (const OocEdge *)p1;
+    const OocEdge *pEdge2 = (const OocEdge *)p2;
+    if (pEdge1->uTo != pEdge2->uTo)
+        return pEdge1->uTo < pEdge2->uTo ? -1 : 1;
+    return 0;
+}
+int compareOocLevel(const void *p1, const void *p2)
+{
+    const OocLevelEdge *pEdge1 = (const OocLevelEdge *)p1;
+    const OocLevelEdge *pEdge2 = (const OocLevelEdge *)p2;
+    if (pEdge1->uLevel != pEdge2->uLevel)
+        return pEdge1->uLevel < pEdge2->uLevel ? -1 : 1;
+    if (pEdge1->uFrom != pEdge2->uFrom)
+        return pEdge1->uFrom < pEdge2->uFrom ? -1 : 1;
+    if (pEdge1->uTo != pEdge2->uTo)
+        return pEdge1->uTo < pEdge2->uTo ? -1 : 1;
+    return 0;
+}
+int compareOocUpdates(const void *p1, const void *p2)
+{
+    const OocUpdate *pUpdate1 = (const OocUpdate *)p1;
+    const OocUpdate *pUpdate2 = (const OocUpdate *)p2;
+    if (pUpdate1->uVertex != pUpdate2->uVertex)
+        return pUpdate1->uVertex < pUpdate2->uVertex ? -1 : 1;
+    return 0;
+}
+int compareOocIds(const void *p1, const void *p2)
+{
+    uint32_t u1 = *(const uint32_t *)p1;
+    uint32_t u2 = *(const uint32_t *)p2;
+    if (u1 != u2)
+        return u1 < u2 ? -1 : 1;
+    return 0;
 }
 
 // Linked list manipulation routines used for successor and predecessor lists
@@ -722,43 +5222,6 @@ EdgeNode *searchLL(EdgeNode *pHead, int match, EdgeNode **ppPrecedes)
     return NULL;
 }
 
-EdgeNode *insertOrderedLL(EdgeNode **pHead, Edge value)
-{
-    EdgeNode *pNew, *pFind, *pPrecedes;
-    // see if it already exists
-    pFind = searchLL(*pHead, value.iVertex, &pPrecedes);
-    if (pFind != NULL)
-        return pFind;
-
-    // doesn't already exist.  Allocate a node and insert.
-    pNew = allocateEdgeNode(value);
-
-    // Check for inserting at the beginning of the list
-    // this will also handle when the list is empty
-    if (pPrecedes == NULL)
-    {
-        pNew->pNextEdge = *pHead;
-        *pHead = pNew;
-    }
-    else
-    {
-        pNew->pNextEdge = pPrecedes->pNextEdge;
-        pPrecedes->pNextEdge = pNew;
-    }
-    return pNew;
-}
-
-EdgeNode *allocateEdgeNode(Edge value)
-{
-    EdgeNode *pNew;
-    pNew = (EdgeNode *)malloc(sizeof(EdgeNode));
-    if (pNew == NULL)
-        ErrExit(ERR_ALGORITHM, "No available memory for linked list");
-    pNew->edge = value;
-    pNew->pNextEdge = NULL;
-    return pNew;
-}
-
 /******************** ErrExit **************************************
   void ErrExit(int iexitRC, char szFmt[], ... )
 Purpose:
@@ -842,7 +5305,10 @@ void exitUsage(int iArg, char *pszMessage, char *pszDiagnosticInfo)
             , pszDiagnosticInfo);
     }
     // print the usage information for any type of command line error
-    fprintf(stderr, "p6 \n");
+    fprintf(stderr, "p6 [-f text|csv|jsonl|bin] [-t] [-c cacheFile [-n entries]] [-k]\n");
+    fprintf(stderr, "   [-w scenarioFile] < inputFile\n");
+    fprintf(stderr, "p6 -s socketPath\n");
+    fprintf(stderr, "p6 -x resultFile [-m megabytes] < edgeFile\n");
     if (iArg == USAGE_ONLY)
         exit(USAGE_ONLY);
     else